@@ -0,0 +1,255 @@
+/* ------------------------------------------------------------ *
+ * file:        acq_bno055.c                                    *
+ * purpose:     Multi-sensor acquisition engine. Sensors are    *
+ *              grouped by bus, one worker thread per bus reads *
+ *              its sensors round-robin with get_snapshot(), so *
+ *              separate buses are read in parallel. The time-  *
+ *              stamped samples of all sensors go into a common *
+ *              lock-free ring, taken out with bno_acq_read(),  *
+ *              so a slow consumer never delays a bus read.     *
+ *              Recorded sources (replay) wait for ring space   *
+ *              instead, and their worker ends with the data.   *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Engine state. A worker only touches the handles of its own   *
+ * bus, the workers push into the shared ring: SPSC if there is *
+ * a single bus, else MPSC.                                     *
+ * ------------------------------------------------------------ */
+struct bnoacq{
+   int count;                          // number of sensors
+   bno055_t *dev[BNO_ACQ_MAX];         // sensor handles
+   char bus[BNO_ACQ_MAX][256];         // bus name per sensor
+   int  busid[BNO_ACQ_MAX];            // worker index per sensor
+   int  recorded[BNO_ACQ_MAX];         // 1 = replayed data, never dropped
+   int  nbus;                          // number of distinct buses
+   pthread_t worker[BNO_ACQ_MAX];      // one thread per bus
+   int  running;                       // workers have been started
+   int  active;                        // workers not yet ended, atomic
+   int  stop;                          // ask the workers to end, atomic
+   double hz;                          // bus sweep rate, 0 = free run
+   int  verbose;                       // debug flag
+   struct bnoring *ring;               // sample ring, made by bno_acq_start()
+   unsigned long overruns;             // sweep deadlines missed, atomic
+};
+
+struct acqworker{
+   struct bnoacq *acq;
+   int busid;
+};
+
+/* ------------------------------------------------------------ *
+ * acq_worker() - bus thread: wait for the next sampler deadline*
+ * if a rate was set, then sweep all sensors on the bus. Ends   *
+ * when asked to, or when all its sensors ran out of data or    *
+ * went away. Transient bus errors only cost the one sample.    *
+ * ------------------------------------------------------------ */
+static void *acq_worker(void *arg) {
+   struct acqworker *w = arg;
+   struct bnoacq *acq = w->acq;
+   struct bnotick tk;
+   int ended[BNO_ACQ_MAX] = {0};
+   int left = 0;
+   int i;
+   if(acq->hz > 0) bno_tick_init(&tk, acq->hz);
+   for(i = 0; i < acq->count; i++) if(acq->busid[i] == w->busid) left++;
+
+   while(left > 0 && !__atomic_load_n(&acq->stop, __ATOMIC_ACQUIRE)) {
+      if(acq->hz > 0) {
+         int missed = bno_tick_wait(&tk);
+         if(missed > 0) __atomic_fetch_add(&acq->overruns, missed, __ATOMIC_RELAXED);
+      }
+
+      for(i = 0; i < acq->count && !__atomic_load_n(&acq->stop, __ATOMIC_ACQUIRE); i++) {
+         if(acq->busid[i] != w->busid || ended[i]) continue;
+
+         struct bnosample smp;
+         smp.sensor = i;
+         if(get_snapshot(acq->dev[i], &smp.snap) != 0) {
+            int cls = bno_errclass(errno);
+            if(cls == BNO_E_NODATA || cls == BNO_E_NODEV) {
+               if(cls == BNO_E_NODATA)
+                  BNO_DEBUG(acq->verbose, "Debug: sensor %d on [%s] has no more data\n", i, acq->bus[i]);
+               else BNO_ERROR("Error: sensor %d on [%s] is gone, %s\n", i, acq->bus[i], strerror(errno));
+               ended[i] = 1;
+               left--;
+            }
+            else BNO_DEBUG(acq->verbose, "Debug: sensor %d on [%s] read failed\n", i, acq->bus[i]);
+            continue;
+         }
+         if(acq->recorded[i]) bno_ring_push_wait(acq->ring, &smp, &acq->stop);
+         else bno_ring_push(acq->ring, &smp);
+      }
+   }
+   __atomic_fetch_sub(&acq->active, 1, __ATOMIC_RELEASE);
+   free(w);
+   return(NULL);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_new() - create an empty engine. hz is the bus sweep  *
+ * rate, 0 reads as fast as the buses allow.                    *
+ * ------------------------------------------------------------ */
+struct bnoacq *bno_acq_new(double hz, int verbose) {
+   if(hz < 0 || hz > BNO_TICK_MAX_HZ) {
+      BNO_ERROR("Error: invalid sample rate %.2f Hz, max %d Hz.\n", hz, BNO_TICK_MAX_HZ);
+      return(NULL);
+   }
+   struct bnoacq *acq = calloc(1, sizeof(struct bnoacq));
+   if(acq == NULL) {
+      BNO_ERROR("Error: cannot allocate the acquisition engine.\n");
+      return(NULL);
+   }
+   acq->hz = hz;
+   acq->verbose = verbose;
+   return(acq);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_add() - open the sensor at addr on bus and add it to *
+ * the engine. Sensors with the same bus name share a worker.   *
+ * Returns the sensor index used in the samples, or -1.         *
+ * ------------------------------------------------------------ */
+int bno_acq_add(struct bnoacq *acq, const char *bus, const char *addr) {
+   if(acq->running) {
+      BNO_ERROR("Error: cannot add sensors to a running acquisition.\n");
+      return(-1);
+   }
+   if(acq->count == BNO_ACQ_MAX) {
+      BNO_ERROR("Error: acquisition supports max %d sensors.\n", BNO_ACQ_MAX);
+      return(-1);
+   }
+   if(strlen(bus) >= sizeof(acq->bus[0])) {
+      BNO_ERROR("Error: invalid bus name [%s].\n", bus);
+      return(-1);
+   }
+
+   bno055_t *bno = bno_open(bus, addr, acq->verbose);
+   if(bno == NULL) return(-1);
+
+   int i = acq->count;
+   acq->dev[i] = bno;
+   strcpy(acq->bus[i], bus);
+   acq->busid[i] = acq->nbus;
+   acq->recorded[i] = (bno->bus.stamp != NULL);
+
+   int j;
+   for(j = 0; j < i; j++) {
+      if(strcmp(acq->bus[j], bus) == 0) {
+         acq->busid[i] = acq->busid[j];
+         break;
+      }
+   }
+   if(acq->busid[i] == acq->nbus) acq->nbus++;
+   BNO_DEBUG(acq->verbose, "Debug: sensor %d [%s] at [%s] on bus worker %d\n", i, addr, bus, acq->busid[i]);
+   acq->count++;
+   return(i);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_dev() - the handle of sensor index i, e.g. to read   *
+ * its setup. Only while the workers are not running.           *
+ * ------------------------------------------------------------ */
+bno055_t *bno_acq_dev(struct bnoacq *acq, int i) {
+   if(i < 0 || i >= acq->count) return(NULL);
+   return(acq->dev[i]);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_start() - spawn one worker thread per bus            *
+ * ------------------------------------------------------------ */
+int bno_acq_start(struct bnoacq *acq) {
+   int b;
+   if(acq->running || acq->count == 0) return(-1);
+
+   if(acq->ring == NULL) {
+      acq->ring = bno_ring_new(BNO_ACQ_QUEUE, acq->nbus > 1 ? BNO_RING_MPSC : BNO_RING_SPSC);
+      if(acq->ring == NULL) return(-1);
+   }
+
+   __atomic_store_n(&acq->stop, 0, __ATOMIC_RELEASE);
+   __atomic_store_n(&acq->active, acq->nbus, __ATOMIC_RELEASE);
+   for(b = 0; b < acq->nbus; b++) {
+      struct acqworker *w = malloc(sizeof(struct acqworker));
+      if(w == NULL) break;
+      w->acq = acq;
+      w->busid = b;
+      if(pthread_create(&acq->worker[b], NULL, acq_worker, w) != 0) {
+         free(w);
+         break;
+      }
+   }
+   acq->running = b;
+   if(b < acq->nbus) {
+      __atomic_fetch_sub(&acq->active, acq->nbus - b, __ATOMIC_RELEASE);
+      BNO_ERROR("Error: cannot start acquisition worker %d.\n", b);
+      bno_acq_stop(acq);
+      return(-1);
+   }
+   BNO_DEBUG(acq->verbose, "Debug: acquisition started, %d sensors on %d buses\n", acq->count, acq->nbus);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_read() - take the oldest sample out of the ring,     *
+ * waiting up to timeout_ms for one. Returns 0, or -1 if none   *
+ * arrived in time. Only one thread may read.                   *
+ * ------------------------------------------------------------ */
+int bno_acq_read(struct bnoacq *acq, struct bnosample *smp, int timeout_ms) {
+   if(acq->ring == NULL) return(-1);
+   return bno_ring_read(acq->ring, smp, timeout_ms);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_active() - bus workers still running. Drops to 0 once*
+ * all sensors reached the end of a replayed capture, samples   *
+ * may still wait in the ring then.                             *
+ * ------------------------------------------------------------ */
+int bno_acq_active(struct bnoacq *acq) {
+   return __atomic_load_n(&acq->active, __ATOMIC_ACQUIRE);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_dropped() - samples lost because the ring was full   *
+ * ------------------------------------------------------------ */
+unsigned long bno_acq_dropped(struct bnoacq *acq) {
+   if(acq->ring == NULL) return(0);
+   return bno_ring_overruns(acq->ring);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_overruns() - sweep deadlines the bus workers missed  *
+ * ------------------------------------------------------------ */
+unsigned long bno_acq_overruns(struct bnoacq *acq) {
+   return __atomic_load_n(&acq->overruns, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_stop() - end and join the worker threads             *
+ * ------------------------------------------------------------ */
+void bno_acq_stop(struct bnoacq *acq) {
+   int b;
+   __atomic_store_n(&acq->stop, 1, __ATOMIC_RELEASE);
+   for(b = 0; b < acq->running; b++) pthread_join(acq->worker[b], NULL);
+   acq->running = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_acq_close() - stop the engine, close all sensor handles  *
+ * ------------------------------------------------------------ */
+void bno_acq_close(struct bnoacq *acq) {
+   int i;
+   if(acq == NULL) return;
+   bno_acq_stop(acq);
+   for(i = 0; i < acq->count; i++) bno_close(acq->dev[i]);
+   bno_ring_free(acq->ring);
+   free(acq);
+}
@@ -0,0 +1,209 @@
+/* ------------------------------------------------------------ *
+ * file:        aio_bno055.c                                    *
+ * purpose:     Asynchronous sensor access. A dedicated I/O     *
+ *              thread owns the device handle and works off a   *
+ *              submission queue, so callers never block on bus *
+ *              transactions or the set_mode() switch delays.   *
+ *              Completions go to a callback, or are queued and *
+ *              signalled on an eventfd that works with poll(). *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Queue state. outstanding counts requests from submission to  *
+ * reap, it caps both rings, so a completion always has a slot. *
+ * ------------------------------------------------------------ */
+struct bnoaio{
+   bno055_t *bno;                      // handle, owned by the thread
+   pthread_t thread;                   // the I/O thread
+   int  efd;                           // eventfd, counts completions
+   int  stop;                          // drain the queue and exit
+
+   pthread_mutex_t lock;               // protects everything below
+   pthread_cond_t  wake;               // signals new submissions
+   struct bnoreq sq[BNO_AIO_DEPTH];    // submission ring
+   int  sq_head;
+   int  sq_len;
+   struct bnocqe cq[BNO_AIO_DEPTH];    // completion ring
+   int  cq_head;
+   int  cq_len;
+   int  outstanding;                   // submitted, not reaped yet
+};
+
+/* ------------------------------------------------------------ *
+ * aio_exec() - run one request on the I/O thread               *
+ * ------------------------------------------------------------ */
+static int aio_exec(bno055_t *bno, struct bnoreq *req) {
+   switch(req->op) {
+      case bno_op_read:
+         return bno_read_regs(bno, req->reg, req->buf, req->len);
+      case bno_op_write:
+         return bno_write_regs(bno, req->reg, req->buf, req->len);
+      case bno_op_snapshot:
+         return get_snapshot(bno, req->buf);
+      case bno_op_mode:
+         return set_mode(bno, (opmode_t) req->arg);
+      case bno_op_power:
+         return set_power(bno, (power_t) req->arg);
+      case bno_op_reset:
+         return bno_reset(bno);
+   }
+   return(-1);
+}
+
+static void *aio_thread(void *arg) {
+   struct bnoaio *aio = arg;
+
+   pthread_mutex_lock(&aio->lock);
+   for(;;) {
+      while(aio->sq_len == 0 && !aio->stop) pthread_cond_wait(&aio->wake, &aio->lock);
+      if(aio->sq_len == 0) break;   // stop requested, queue drained
+
+      struct bnoreq req = aio->sq[aio->sq_head];
+      aio->sq_head = (aio->sq_head + 1) % BNO_AIO_DEPTH;
+      aio->sq_len--;
+      pthread_mutex_unlock(&aio->lock);
+
+      int res = aio_exec(aio->bno, &req);
+      if(req.callback != NULL) req.callback(req.user, res);
+
+      pthread_mutex_lock(&aio->lock);
+      if(req.callback != NULL) {
+         aio->outstanding--;
+         continue;
+      }
+      struct bnocqe *cqe = &aio->cq[(aio->cq_head + aio->cq_len) % BNO_AIO_DEPTH];
+      cqe->op   = req.op;
+      cqe->res  = res;
+      cqe->user = req.user;
+      aio->cq_len++;
+
+      uint64_t one = 1;
+      if(write(aio->efd, &one, sizeof(one)) != sizeof(one)) {
+         BNO_DEBUG(aio->bno->verbose, "Debug: aio eventfd write failed\n");
+      }
+   }
+   pthread_mutex_unlock(&aio->lock);
+   return(NULL);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_aio_start() - start the I/O thread for an open handle.   *
+ * Until bno_aio_stop(), only the I/O thread may use the handle.*
+ * ------------------------------------------------------------ */
+struct bnoaio *bno_aio_start(bno055_t *bno) {
+   struct bnoaio *aio = calloc(1, sizeof(struct bnoaio));
+   if(aio == NULL) {
+      BNO_ERROR("Error: cannot allocate the async I/O queues.\n");
+      return(NULL);
+   }
+   aio->bno = bno;
+   aio->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+   if(aio->efd < 0) {
+      BNO_ERROR("Error: cannot create the async I/O eventfd.\n");
+      free(aio);
+      return(NULL);
+   }
+   pthread_mutex_init(&aio->lock, NULL);
+   pthread_cond_init(&aio->wake, NULL);
+
+   if(pthread_create(&aio->thread, NULL, aio_thread, aio) != 0) {
+      BNO_ERROR("Error: cannot start the async I/O thread.\n");
+      close(aio->efd);
+      free(aio);
+      return(NULL);
+   }
+   BNO_DEBUG(bno->verbose, "Debug: async I/O thread started, queue depth %d\n", BNO_AIO_DEPTH);
+   return(aio);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_aio_submit() - queue a request, returns at once. Buffers *
+ * in the request must stay valid until its completion. Returns *
+ * -1 with errno EAGAIN if BNO_AIO_DEPTH requests are pending.  *
+ * ------------------------------------------------------------ */
+int bno_aio_submit(struct bnoaio *aio, const struct bnoreq *req) {
+   pthread_mutex_lock(&aio->lock);
+   if(aio->stop || aio->outstanding == BNO_AIO_DEPTH) {
+      pthread_mutex_unlock(&aio->lock);
+      errno = EAGAIN;
+      return(-1);
+   }
+   aio->sq[(aio->sq_head + aio->sq_len) % BNO_AIO_DEPTH] = *req;
+   aio->sq_len++;
+   aio->outstanding++;
+   pthread_cond_signal(&aio->wake);
+   pthread_mutex_unlock(&aio->lock);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_aio_fd() - eventfd that becomes readable when completions*
+ * are waiting, for use in the caller's poll() or epoll loop.   *
+ * ------------------------------------------------------------ */
+int bno_aio_fd(struct bnoaio *aio) {
+   return(aio->efd);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_aio_reap() - collect up to max completions, waiting up   *
+ * to timeout_ms for the first one (0 = don't wait, -1 = wait   *
+ * forever). Returns the number of completions copied to cqe.   *
+ * ------------------------------------------------------------ */
+int bno_aio_reap(struct bnoaio *aio, struct bnocqe *cqe, int max, int timeout_ms) {
+   int n = 0;
+
+   if(timeout_ms != 0) {
+      struct pollfd pfd = { aio->efd, POLLIN, 0 };
+      while(poll(&pfd, 1, timeout_ms) < 0 && errno == EINTR);
+   }
+
+   pthread_mutex_lock(&aio->lock);
+   while(n < max && aio->cq_len > 0) {
+      cqe[n++] = aio->cq[aio->cq_head];
+      aio->cq_head = (aio->cq_head + 1) % BNO_AIO_DEPTH;
+      aio->cq_len--;
+      aio->outstanding--;
+   }
+   /* --------------------------------------------------------- *
+    * reset the eventfd counter once the ring is empty, so the  *
+    * fd is only readable while completions are waiting         *
+    * --------------------------------------------------------- */
+   if(aio->cq_len == 0) {
+      uint64_t count;
+      if(read(aio->efd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+         BNO_DEBUG(aio->bno->verbose, "Debug: aio eventfd read failed\n");
+      }
+   }
+   pthread_mutex_unlock(&aio->lock);
+   return(n);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_aio_stop() - run the requests still queued, then end the *
+ * I/O thread. The handle is the caller's again afterwards.     *
+ * ------------------------------------------------------------ */
+void bno_aio_stop(struct bnoaio *aio) {
+   if(aio == NULL) return;
+   pthread_mutex_lock(&aio->lock);
+   aio->stop = 1;
+   pthread_cond_signal(&aio->wake);
+   pthread_mutex_unlock(&aio->lock);
+   pthread_join(aio->thread, NULL);
+
+   close(aio->efd);
+   pthread_cond_destroy(&aio->wake);
+   pthread_mutex_destroy(&aio->lock);
+   free(aio);
+}
@@ -0,0 +1,75 @@
+/* ------------------------------------------------------------ *
+ * file:        batch_bno055.c                                  *
+ * purpose:     Struct of arrays sample batches. The raw data   *
+ *              registers of many samples are sorted into one   *
+ *              int16 array per channel, as given by the caller *
+ *              in struct bnobatch. Nothing is converted to     *
+ *              floating point on the way, loggers and links    *
+ *              keep the sensor values as they were read, and   *
+ *              consumers scale whole arrays with one call of   *
+ *              bno_batch_scale() when they need the units.     *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "getbno055.h"
+
+_Static_assert(2 * BNO_RAW_CHANNELS + BNO_RAW_STATUS == SNAPSHOT_BYTECOUNT,
+               "raw channels do not match the snapshot");
+
+/* ------------------------------------------------------------ *
+ * bno_batch_add() - append the data registers 0x08-0x3B in reg *
+ * of a sample, as kept in bnosnap.raw or a capture record, to  *
+ * the arrays. Returns -1 if the batch is full.                 *
+ * ------------------------------------------------------------ */
+int bno_batch_add(struct bnobatch *b, const unsigned char *reg, int sensor, int64_t tstamp_ns) {
+   if(b->count >= b->size) return(-1);
+   int n = b->count++;
+   int i;
+
+   if(b->tstamp_ns != NULL) b->tstamp_ns[n] = tstamp_ns;
+   if(b->sensor != NULL) b->sensor[n] = sensor;
+   for(i = 0; i < BNO_RAW_CHANNELS; i++) {
+      if(b->ch[i] != NULL) b->ch[i][n] = (int16_t)((reg[2*i+1] << 8) | reg[2*i]);
+   }
+   for(i = 0; i < BNO_RAW_STATUS; i++) {
+      if(b->status[i] != NULL) b->status[i][n] = reg[2*BNO_RAW_CHANNELS + i];
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_batch_sample() - append an acquired sample               *
+ * ------------------------------------------------------------ */
+int bno_batch_sample(struct bnobatch *b, const struct bnosample *smp) {
+   const struct bnotime *ts = &smp->snap.ts;
+   return(bno_batch_add(b, smp->snap.raw, smp->sensor,
+                        (int64_t) ts->tstamp.tv_sec * 1000000000LL + ts->tstamp.tv_nsec));
+}
+
+/* ------------------------------------------------------------ *
+ * bno_batch_cap() - fill the batch with the data records of a  *
+ * capture file from slot on, raw and packed files alike. The   *
+ * return is the slot to continue with, bno_cap_slots() at the  *
+ * end of the file.                                             *
+ * ------------------------------------------------------------ */
+long bno_batch_cap(struct bnobatch *b, struct bnocapfile *cf, long slot) {
+   const struct bnorec *r;
+   for(; b->count < b->size && (r = bno_cap_rec(cf, slot)) != NULL; slot++) {
+      if(r->type == BNO_REC_DATA) bno_batch_add(b, r->reg, r->sensor, r->tstamp_ns);
+   }
+   return(slot);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_batch_scale() - convert n raw values of one channel to   *
+ * units, out[i] = in[i] / div with the divisor of bno_raw_div()*
+ * The results equal those of get_acc() - get_lin().            *
+ * ------------------------------------------------------------ */
+void bno_batch_scale(const int16_t *in, double *out, int n, double div) {
+   int i;
+   for(i = 0; i < n; i++) out[i] = (double) in[i] / div;
+}
@@ -0,0 +1,352 @@
+/* ------------------------------------------------------------ *
+ * file:        bench_bno055.c                                  *
+ * purpose:     Benchmark of the register block decoders. A set *
+ *              of random data blocks 0x08-0x3B is decoded by   *
+ *              bno_snap_decode() (the per-field double code of *
+ *              get_snapshot() and capture replay), by bnobatch *
+ *              + bno_batch_scale(), and by bno_decode_batch()  *
+ *              with each implementation this CPU supports.     *
+ *              Every batch result is checked against (float)   *
+ *              of the bno_snap_decode() value, bit for bit.    *
+ *              With -a, the async I/O queue of aio_bno055.c is *
+ *              run against a sensor (or the simulator) instead *
+ *              and compared with blocking get_snapshot() calls.*
+ *                                                              *
+ * return:      0 on success, and -1 on errors or mismatches.   *
+ *                                                              *
+ * example:	./bno055bench -n 1000000 -r 5                    *
+ *              ./bno055bench -a sim:400000@0x28 -n 2000        *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <getopt.h>
+#include <poll.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Global variables and defaults                                *
+ * ------------------------------------------------------------ */
+int verbose = 0;
+int samples = 1000000;          // -n register blocks per run
+int rounds = 5;                 // -r runs per decoder, best is shown
+char aiosens[256] = "";         // -a bus@addr for the async I/O run
+
+/* ------------------------------------------------------------ *
+ * print_usage() prints the programs commandline instructions.  *
+ * ------------------------------------------------------------ */
+void usage() {
+   static char const usage[] = "Usage: bno055bench [-n samples] [-r rounds] [-a bus@addr] [-v]\n\
+\n\
+Command line parameters have the following format:\n\
+   -n   number of random register blocks, default 1000000\n\
+        or snapshots with -a\n\
+   -r   runs per decoder, the fastest is reported, default 5\n\
+   -a   instead of the decoders, run snapshots through the async I/O\n\
+        queue of this sensor, Example: -a sim:400000@0x28\n\
+   -h   display this message\n\
+   -v   enable debug output\n\
+\n\
+Usage examples:\n\
+./bno055bench\n\
+./bno055bench -n 100000 -r 20\n\
+./bno055bench -a sim:400000@0x28 -n 2000\n";
+   printf(usage);
+}
+
+/* ------------------------------------------------------------ *
+ * parseargs() checks the commandline arguments with C getopt   *
+ * ------------------------------------------------------------ */
+void parseargs(int argc, char* argv[]) {
+   int arg;
+   opterr = 0;
+
+   while ((arg = (int) getopt (argc, argv, "n:r:a:hv")) != -1) {
+      switch (arg) {
+         case 'n':
+            samples = atoi(optarg);
+            if(samples < 1) {
+               printf("Error: Cannot get valid -n sample count argument.\n");
+               exit(-1);
+            }
+            break;
+         case 'r':
+            rounds = atoi(optarg);
+            if(rounds < 1) {
+               printf("Error: Cannot get valid -r rounds argument.\n");
+               exit(-1);
+            }
+            break;
+         case 'a':
+            if(strlen(optarg) >= sizeof(aiosens) || strrchr(optarg, '@') == NULL) {
+               printf("Error: Cannot get valid -a bus@addr argument.\n");
+               exit(-1);
+            }
+            strncpy(aiosens, optarg, sizeof(aiosens));
+            break;
+         case 'v':
+            verbose = 1;
+            break;
+         case 'h':
+            usage();
+            exit(0);
+            break;
+         case '?':
+            if(isprint (optopt))
+               printf ("Error: Unknown option `-%c'.\n", optopt);
+            else
+               printf ("Error: Unknown option character `\\x%x'.\n", optopt);
+            usage();
+            exit(-1);
+            break;
+         default:
+            usage();
+            break;
+      }
+   }
+}
+
+static double now_ns() {
+   struct timespec t;
+   clock_gettime(CLOCK_MONOTONIC, &t);
+   return(t.tv_sec * 1e9 + t.tv_nsec);
+}
+
+/* ------------------------------------------------------------ *
+ * snap_values() - the 22 channel values of a decoded snapshot  *
+ * in channel order, for the comparison                         *
+ * ------------------------------------------------------------ */
+static void snap_values(const struct bnosnap *s, double *v) {
+   double a[BNO_RAW_CHANNELS] = {
+      s->acc.adata_x, s->acc.adata_y, s->acc.adata_z,
+      s->mag.mdata_x, s->mag.mdata_y, s->mag.mdata_z,
+      s->gyr.gdata_x, s->gyr.gdata_y, s->gyr.gdata_z,
+      s->eul.eul_head, s->eul.eul_roll, s->eul.eul_pitc,
+      s->qua.quater_w, s->qua.quater_x, s->qua.quater_y, s->qua.quater_z,
+      s->lin.linacc_x, s->lin.linacc_y, s->lin.linacc_z,
+      s->gra.gravityx, s->gra.gravityy, s->gra.gravityz };
+   memcpy(v, a, sizeof(a));
+}
+
+/* ------------------------------------------------------------ *
+ * aio_count() - completion callback, counts on the I/O thread  *
+ * ------------------------------------------------------------ */
+static void aio_count(void *user, int res) {
+   if(res == 0) __atomic_fetch_add((int *) user, 1, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------ *
+ * aio_bench() - "-a" read samples snapshots, first blocking,   *
+ * then through the async queue with up to BNO_AIO_DEPTH of     *
+ * them in flight, collected via poll() on the eventfd. Then a  *
+ * mode switch and reads with callbacks, the last of them still *
+ * queued when bno_aio_stop() has to drain them.                *
+ * ------------------------------------------------------------ */
+static int aio_bench() {
+   char *at = strrchr(aiosens, '@');
+   *at = '\0';
+   bno055_t *bno = bno_open(aiosens, at + 1, verbose);
+   if(bno == NULL) return(-1);
+
+   struct bnosnap *snap = calloc(BNO_AIO_DEPTH, sizeof(struct bnosnap));
+   if(snap == NULL) {
+      bno_close(bno);
+      return(-1);
+   }
+   int i, errors = 0;
+
+   double t0 = now_ns();
+   for(i = 0; i < samples; i++) if(get_snapshot(bno, &snap[0]) != 0) errors++;
+   double tsync = now_ns() - t0;
+
+   struct bnoaio *aio = bno_aio_start(bno);
+   if(aio == NULL) {
+      free(snap);
+      bno_close(bno);
+      return(-1);
+   }
+   /* --------------------------------------------------------- *
+    * keep the queue full, the request cookie is the snap slot  *
+    * --------------------------------------------------------- */
+   struct pollfd pfd = { bno_aio_fd(aio), POLLIN, 0 };
+   struct bnocqe cqe[BNO_AIO_DEPTH];
+   int sent = 0, done = 0, inflight = 0, free_slot[BNO_AIO_DEPTH], nfree = BNO_AIO_DEPTH;
+   double tsubmit = 0;
+   for(i = 0; i < BNO_AIO_DEPTH; i++) free_slot[i] = i;
+
+   t0 = now_ns();
+   while(done < samples) {
+      while(sent < samples && nfree > 0) {
+         int slot = free_slot[--nfree];
+         struct bnoreq req = { bno_op_snapshot, 0, 0, &snap[slot], 0, NULL, (void *)(long) slot };
+         double ts = now_ns();
+         if(bno_aio_submit(aio, &req) != 0) { free_slot[nfree++] = slot; break; }
+         tsubmit += now_ns() - ts;
+         sent++;
+         inflight++;
+      }
+      if(poll(&pfd, 1, 1000) <= 0) {
+         printf("Error: no async completion for 1s, %d in flight.\n", inflight);
+         errors++;
+         break;
+      }
+      int n = bno_aio_reap(aio, cqe, BNO_AIO_DEPTH, 0);
+      for(i = 0; i < n; i++) {
+         if(cqe[i].op != bno_op_snapshot || cqe[i].res != 0) errors++;
+         free_slot[nfree++] = (int)(long) cqe[i].user;
+      }
+      done += n;
+      inflight -= n;
+   }
+   double tasync = now_ns() - t0;
+
+   /* --------------------------------------------------------- *
+    * callbacks: a CONFIG round trip, then reads left queued    *
+    * --------------------------------------------------------- */
+   int cbok = 0, cbsent = 0;
+   unsigned char reg[BNO_AIO_DEPTH][6];
+   int mode = get_mode(bno);
+   struct bnoreq mreq = { bno_op_mode, 0, 0, NULL, config, aio_count, &cbok };
+   if(bno_aio_submit(aio, &mreq) == 0) cbsent++;
+   mreq.arg = mode;
+   if(bno_aio_submit(aio, &mreq) == 0) cbsent++;
+   for(i = 0; i < BNO_AIO_DEPTH - 2; i++) {
+      struct bnoreq rreq = { bno_op_read, BNO055_ACC_DATA_X_LSB_ADDR, 6, reg[i], 0, aio_count, &cbok };
+      if(bno_aio_submit(aio, &rreq) == 0) cbsent++;
+   }
+   t0 = now_ns();
+   bno_aio_stop(aio);
+   double tstop = now_ns() - t0;
+   if(cbok != cbsent) errors++;
+
+   printf("Snapshots of %s@%s, %d each\n", aiosens, at + 1, samples);
+   printf("%-26s %10.2f ms %8.2f us/sample\n", "get_snapshot (blocking)", tsync / 1e6, tsync / samples / 1e3);
+   printf("%-26s %10.2f ms %8.2f us/sample, %.2f us in submit\n", "bno_aio_submit + reap",
+          tasync / 1e6, tasync / done / 1e3, tsubmit / sent / 1e3);
+   printf("%-26s %d of %d callbacks OK, stop drained the queue in %.2f ms\n", "mode switch + reads",
+          cbok, cbsent, tstop / 1e6);
+
+   free(snap);
+   bno_close(bno);
+   if(errors > 0) {
+      printf("Error: %d async I/O failures.\n", errors);
+      return(-1);
+   }
+   return(0);
+}
+
+int main(int argc, char *argv[]) {
+   parseargs(argc, argv);
+   if(strlen(aiosens) > 0) exit(aio_bench());
+
+   /* --------------------------------------------------------- *
+    * Random blocks, UNIT_SEL changes every 1000 samples so the *
+    * decoders also see mixed units within 8 samples.           *
+    * --------------------------------------------------------- */
+   unsigned char *regs = malloc((size_t) samples * SNAPSHOT_BYTECOUNT);
+   struct bnosnap *snap = malloc(sizeof(struct bnosnap) * samples);
+   float *fout = malloc(sizeof(float) * BNO_RAW_CHANNELS * (size_t) samples);
+   double *dout = malloc(sizeof(double) * BNO_RAW_CHANNELS * (size_t) samples);
+   int16_t *iout = malloc(sizeof(int16_t) * BNO_RAW_CHANNELS * (size_t) samples);
+   if(regs == NULL || snap == NULL || fout == NULL || dout == NULL || iout == NULL) {
+      printf("Error: Cannot allocate buffers for %d samples.\n", samples);
+      exit(-1);
+   }
+   int i, ch, r, impl;
+   srandom(1);
+   for(i = 0; i < samples * SNAPSHOT_BYTECOUNT; i++) regs[i] = random();
+   for(i = 0; i < samples; i++)
+      regs[(size_t) i * SNAPSHOT_BYTECOUNT + BNO055_UNIT_SEL_ADDR - SNAPSHOT_START] = (i / 1000) & 0x01;
+
+   float *fch[BNO_RAW_CHANNELS];
+   double *dch[BNO_RAW_CHANNELS];
+   struct bnobatch b;
+   memset(&b, 0, sizeof(b));
+   b.size = samples;
+   for(ch = 0; ch < BNO_RAW_CHANNELS; ch++) {
+      fch[ch] = fout + (size_t) ch * samples;
+      dch[ch] = dout + (size_t) ch * samples;
+      b.ch[ch] = iout + (size_t) ch * samples;
+   }
+
+   printf("Decoding %d register blocks, best of %d runs\n", samples, rounds);
+   printf("%-26s %10s %10s %8s\n", "decoder", "ms", "ns/sample", "speedup");
+
+   /* --------------------------------------------------------- *
+    * Reference: bno_snap_decode() per sample                   *
+    * --------------------------------------------------------- */
+   double best = 0, base = 0;
+   for(r = 0; r < rounds; r++) {
+      double t0 = now_ns();
+      for(i = 0; i < samples; i++)
+         bno_snap_decode(regs + (size_t) i * SNAPSHOT_BYTECOUNT, &snap[i]);
+      double t = now_ns() - t0;
+      if(r == 0 || t < best) best = t;
+   }
+   base = best;
+   printf("%-26s %10.2f %10.2f %7.2fx\n", "bno_snap_decode (double)",
+          best / 1e6, best / samples, 1.0);
+
+   /* --------------------------------------------------------- *
+    * bnobatch int16 arrays, then bno_batch_scale() per channel *
+    * --------------------------------------------------------- */
+   for(r = 0; r < rounds; r++) {
+      double t0 = now_ns();
+      b.count = 0;
+      for(i = 0; i < samples; i++)
+         bno_batch_add(&b, regs + (size_t) i * SNAPSHOT_BYTECOUNT, 0, 0);
+      for(ch = 0; ch < BNO_RAW_CHANNELS; ch++)
+         bno_batch_scale(b.ch[ch], dch[ch], samples, bno_raw_div(ch, 0));
+      double t = now_ns() - t0;
+      if(r == 0 || t < best) best = t;
+   }
+   printf("%-26s %10.2f %10.2f %7.2fx\n", "bno_batch_scale (double)",
+          best / 1e6, best / samples, base / best);
+
+   /* --------------------------------------------------------- *
+    * bno_decode_batch() with each available implementation     *
+    * --------------------------------------------------------- */
+   int errors = 0;
+   for(impl = BNO_DEC_SCALAR; impl <= BNO_DEC_NEON; impl++) {
+      if(bno_decode_select(impl) != 0) continue;
+      memset(fout, 0, sizeof(float) * BNO_RAW_CHANNELS * (size_t) samples);
+      for(r = 0; r < rounds; r++) {
+         double t0 = now_ns();
+         bno_decode_batch(regs, SNAPSHOT_BYTECOUNT, samples, fch);
+         double t = now_ns() - t0;
+         if(r == 0 || t < best) best = t;
+      }
+      char name[32];
+      snprintf(name, sizeof(name), "bno_decode_batch %s", bno_decode_name());
+      printf("%-26s %10.2f %10.2f %7.2fx\n", name, best / 1e6, best / samples, base / best);
+
+      int bad = 0;
+      for(i = 0; i < samples; i++) {
+         double v[BNO_RAW_CHANNELS];
+         snap_values(&snap[i], v);
+         for(ch = 0; ch < BNO_RAW_CHANNELS; ch++) {
+            float want = (float) v[ch];
+            if(memcmp(&fch[ch][i], &want, sizeof(float)) == 0) continue;
+            if(verbose == 1 && bad < 10)
+               printf("Debug: %s sample %d channel %d: %.9g != %.9g\n",
+                      bno_decode_name(), i, ch, fch[ch][i], want);
+            bad++;
+         }
+      }
+      if(bad > 0) printf("Error: %s decoder has %d mismatches.\n", bno_decode_name(), bad);
+      errors += bad;
+   }
+   bno_decode_select(BNO_DEC_AUTO);
+   if(verbose == 1) printf("Debug: default decoder %s\n", bno_decode_name());
+
+   free(regs); free(snap); free(fout); free(dout); free(iout);
+   if(errors > 0) exit(-1);
+   printf("All decoder results match bno_snap_decode\n");
+   exit(0);
+}
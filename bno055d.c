@@ -0,0 +1,375 @@
+/* ------------------------------------------------------------ *
+ * file:        bno055d.c                                       *
+ * purpose:     BNO055 sensor daemon. It owns the bus, runs one *
+ *              acquisition loop for all sensors, and serves    *
+ *              any number of clients over a Unix socket. Each  *
+ *              client subscribes to fields, sensors and a rate *
+ *              and gets one binary frame per sample. A client  *
+ *              that does not keep up loses frames (counted in  *
+ *              the frame header), it never stalls the others.  *
+ *                                                              *
+ * return:      0 on success, and -1 on errors.                 *
+ *                                                              *
+ * example:	./bno055d -s /dev/i2c-1@0x28 -u /tmp/bno055.sock *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#define _GNU_SOURCE           // accept4()
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Global variables and defaults                                *
+ * ------------------------------------------------------------ */
+int verbose = 0;                // debug flag, 0 = normal, 1 = debug mode
+char acqsens[BNO_ACQ_MAX][256]; // -s sensor list, bus@addr
+int acqcount = 0;
+char sockpath[108] = BNO_SOCK_PATH; // -u socket path, sun_path size
+double rate = 0;                // -f acquisition rate in Hz, 0 = default
+int tracelen = 0;               // -T bus transactions to trace, 0 = off
+static volatile sig_atomic_t stop = 0;
+static volatile sig_atomic_t dump = 0; // SIGUSR1, print the traces
+
+/* ------------------------------------------------------------ *
+ * Subscriber state. next_ns is the earliest sample time of the *
+ * next frame per sensor, it implements the client frame rate.  *
+ * ------------------------------------------------------------ */
+struct client{
+   int fd;                      // connected socket, non-blocking
+   uint16_t fields;             // BNO_F_ mask, 0 = not subscribed
+   uint32_t sensors;            // sensor bitmask, 0 = all
+   int64_t period_ns;           // frame period, 0 = every sample
+   int64_t next_ns[BNO_ACQ_MAX];
+   uint32_t seq;                // frames sent
+   uint32_t dropped;            // frames dropped, socket buffer full
+};
+struct client clients[BNO_SUB_MAX];
+int nclients = 0;
+
+/* ------------------------------------------------------------ *
+ * print_usage() prints the programs commandline instructions.  *
+ * ------------------------------------------------------------ */
+void usage() {
+   static char const usage[] = "Usage: bno055d [-s bus@addr] [-u socket] [-f hz] [-T n] [-v]\n\
+\n\
+Command line parameters have the following format:\n\
+   -s   sensor to serve, repeat for up to 8 sensors, one thread per bus.\n\
+        Example: -s /dev/i2c-1@0x28 (default), -s sim@0x28 (simulated sensor)\n\
+   -u   Unix socket path for the clients, Example: -u /tmp/bno055.sock (default)\n\
+   -f   acquisition rate in Hz, Example: -f 100 (default, the fusion data rate)\n\
+   -T   trace the last n bus transactions of each sensor, kill -USR1 prints\n\
+        them to stderr. Example: -T 256\n\
+   -h   display this message\n\
+   -v   enable debug output\n\
+\n\
+Clients connect with getbno055 -D <socket>, or the bno_sub_ functions.\n\
+\n\
+Usage examples:\n\
+./bno055d -s /dev/i2c-1@0x28\n\
+./bno055d -s /dev/i2c-0@0x28 -s /dev/i2c-1@0x28 -u /run/bno055.sock -v\n\
+./bno055d -s /dev/i2c-1@0x28 -T 256 & kill -USR1 $!\n";
+   printf(usage);
+}
+
+/* ------------------------------------------------------------ *
+ * parseargs() checks the commandline arguments with C getopt   *
+ * ------------------------------------------------------------ */
+void parseargs(int argc, char* argv[]) {
+   int arg;
+   opterr = 0;
+
+   while ((arg = (int) getopt (argc, argv, "s:u:f:T:hv")) != -1) {
+      switch (arg) {
+         // arg -v verbose, type: flag, optional
+         case 'v':
+            verbose = 1; break;
+
+         // arg -s + sensor bus@addr, type: string, repeatable
+         // example: /dev/i2c-1@0x28
+         case 's':
+            if(verbose == 1) printf("Debug: arg -s, value %s\n", optarg);
+            if (acqcount == BNO_ACQ_MAX || strlen(optarg) >= sizeof(acqsens[0])
+                || strchr(optarg, '@') == NULL) {
+               printf("Error: invalid -s sensor argument.\n");
+               exit(-1);
+            }
+            strncpy(acqsens[acqcount++], optarg, sizeof(acqsens[0]));
+            break;
+
+         // arg -u + socket path, type: string
+         // example: /tmp/bno055.sock
+         case 'u':
+            if(verbose == 1) printf("Debug: arg -u, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(sockpath)) {
+               printf("Error: invalid -u socket path argument.\n");
+               exit(-1);
+            }
+            strncpy(sockpath, optarg, sizeof(sockpath));
+            break;
+
+         // arg -f + acquisition rate in Hz, type: number
+         case 'f':
+            if(verbose == 1) printf("Debug: arg -f, value %s\n", optarg);
+            rate = strtod(optarg, NULL);
+            if(rate <= 0 || rate > BNO_TICK_MAX_HZ) {
+               printf("Error: invalid -f sample rate argument, max %d Hz.\n", BNO_TICK_MAX_HZ);
+               exit(-1);
+            }
+            break;
+
+         // arg -T + trace ring size, type: number
+         case 'T':
+            if(verbose == 1) printf("Debug: arg -T, value %s\n", optarg);
+            tracelen = atoi(optarg);
+            if(tracelen < 1 || tracelen > 1 << 24) {
+               printf("Error: invalid -T trace length argument, 1..%d.\n", 1 << 24);
+               exit(-1);
+            }
+            break;
+
+         // arg -h usage, type: flag, optional
+         case 'h':
+            usage(); exit(0);
+            break;
+
+         case '?':
+            if(isprint (optopt))
+               printf ("Error: Unknown option `-%c'.\n", optopt);
+            else
+               printf ("Error: Unknown option character `\\x%x'.\n", optopt);
+            usage();
+            exit(-1);
+            break;
+
+         default:
+            usage();
+            break;
+      }
+   }
+}
+
+static void on_signal(int sig) {
+   if(sig == SIGUSR1) dump = 1;
+   else stop = 1;
+}
+
+/* ------------------------------------------------------------ *
+ * listen_open() - bind the client socket. A socket file left   *
+ * over from a crashed daemon is replaced, a live one is not.   *
+ * ------------------------------------------------------------ */
+int listen_open(const char *path) {
+   struct sockaddr_un sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sun_family = AF_UNIX;
+   strcpy(sa.sun_path, path);
+
+   int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+   if(fd < 0) {
+      printf("Error: cannot create a socket.\n");
+      return(-1);
+   }
+   if(connect(fd, (struct sockaddr *) &sa, sizeof(sa)) == 0 || errno == EAGAIN) {
+      printf("Error: another bno055d is serving [%s].\n", path);
+      close(fd);
+      return(-1);
+   }
+   unlink(path);
+   if(bind(fd, (struct sockaddr *) &sa, sizeof(sa)) != 0 || listen(fd, 16) != 0) {
+      printf("Error: cannot listen on [%s].\n", path);
+      close(fd);
+      return(-1);
+   }
+   if(verbose == 1) printf("Debug: listening on [%s]\n", path);
+   return(fd);
+}
+
+/* ------------------------------------------------------------ *
+ * client_close() - disconnect client i, the last one moves up  *
+ * ------------------------------------------------------------ */
+void client_close(int i) {
+   if(verbose == 1) printf("Debug: client %d gone, %u frames sent, %u dropped\n",
+                           clients[i].fd, clients[i].seq, clients[i].dropped);
+   close(clients[i].fd);
+   clients[i] = clients[--nclients];
+}
+
+/* ------------------------------------------------------------ *
+ * client_accept() - take all pending connections               *
+ * ------------------------------------------------------------ */
+void client_accept(int lfd) {
+   int fd;
+   while((fd = accept4(lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+      if(nclients == BNO_SUB_MAX) {
+         printf("Error: max %d clients, connection refused.\n", BNO_SUB_MAX);
+         close(fd);
+         continue;
+      }
+      memset(&clients[nclients], 0, sizeof(struct client));
+      clients[nclients].fd = fd;
+      nclients++;
+      if(verbose == 1) printf("Debug: client %d connected, %d clients\n", fd, nclients);
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * client_recv() - apply the subscription requests of client i. *
+ * Returns -1 if the client hung up.                            *
+ * ------------------------------------------------------------ */
+int client_recv(int i) {
+   struct client *c = &clients[i];
+   struct bnosubreq req;
+   ssize_t len;
+
+   while((len = recv(c->fd, &req, sizeof(req), 0)) != 0) {
+      if(len < 0) return((errno == EAGAIN || errno == EINTR) ? 0 : -1);
+      if(len != sizeof(req)) {
+         if(verbose == 1) printf("Debug: client %d sent %zd bytes, ignored\n", c->fd, len);
+         continue;
+      }
+      c->fields    = req.fields & BNO_F_ALL;
+      c->sensors   = req.sensors;
+      c->period_ns = req.rate > 0 ? 1000000000LL / req.rate : 0;
+      memset(c->next_ns, 0, sizeof(c->next_ns));
+      if(verbose == 1) printf("Debug: client %d subscribes fields 0x%02X sensors 0x%X at %u Hz\n",
+                              c->fd, c->fields, c->sensors, req.rate);
+   }
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * distribute() - send a sample to every client subscribed to   *
+ * its sensor whose rate is due. A full socket buffer drops the *
+ * frame for this client only, the loop never blocks.           *
+ * ------------------------------------------------------------ */
+void distribute(const struct bnosample *smp) {
+   unsigned char buf[BNO_FRAME_MAX];
+   struct bnoframe hdr;
+   int64_t ts = (int64_t) smp->snap.ts.tstamp.tv_sec * 1000000000LL + smp->snap.ts.tstamp.tv_nsec;
+   int i, s = smp->sensor;
+
+   for(i = nclients - 1; i >= 0; i--) {
+      struct client *c = &clients[i];
+      if(c->fields == 0) continue;
+      if(c->sensors != 0 && (c->sensors & (1u << s)) == 0) continue;
+
+      /* --------------------------------------------------------- *
+       * rate limit: a quarter period tolerance absorbs the jitter *
+       * of the sample times, late frames restart the schedule     *
+       * --------------------------------------------------------- */
+      if(c->period_ns > 0) {
+         if(ts + c->period_ns / 4 < c->next_ns[s]) continue;
+         c->next_ns[s] += c->period_ns;
+         if(c->next_ns[s] < ts) c->next_ns[s] = ts + c->period_ns;
+      }
+
+      int len = bno_frame_encode(smp, c->fields, buf);
+      memcpy(&hdr, buf, sizeof(hdr));
+      hdr.seq     = c->seq;
+      hdr.dropped = c->dropped;
+      memcpy(buf, &hdr, sizeof(hdr));
+
+      ssize_t res = send(c->fd, buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+      if(res == len) c->seq++;
+      else if(res < 0 && (errno == EAGAIN || errno == ENOBUFS)) c->dropped++;
+      else client_close(i);
+   }
+}
+
+int main(int argc, char *argv[]) {
+   int i;
+
+   parseargs(argc, argv);
+   if(acqcount == 0) snprintf(acqsens[acqcount++], sizeof(acqsens[0]), "%s@0x28", I2CBUS);
+
+   /* ----------------------------------------------------------- *
+    * open all sensors, they stay open for the daemon lifetime    *
+    * ----------------------------------------------------------- */
+   struct bnoacq *acq = bno_acq_new(rate > 0 ? rate : BNO_FUSION_HZ, verbose);
+   if(acq == NULL) exit(-1);
+   for(i = 0; i < acqcount; i++) {
+      char *at = strrchr(acqsens[i], '@');
+      *at = '\0';
+      if(bno_acq_add(acq, acqsens[i], at + 1) < 0
+         || (tracelen > 0 && bno_trace_start(bno_acq_dev(acq, i), tracelen) != 0)) {
+         bno_acq_close(acq);
+         exit(-1);
+      }
+   }
+
+   int lfd = listen_open(sockpath);
+   if(lfd < 0) {
+      bno_acq_close(acq);
+      exit(-1);
+   }
+
+   struct sigaction sa;
+   memset(&sa, 0, sizeof(sa));
+   sa.sa_handler = on_signal;
+   sigaction(SIGINT, &sa, NULL);
+   sigaction(SIGTERM, &sa, NULL);
+   sigaction(SIGUSR1, &sa, NULL);
+   signal(SIGPIPE, SIG_IGN);
+
+   if(bno_acq_start(acq) != 0) {
+      close(lfd);
+      unlink(sockpath);
+      bno_acq_close(acq);
+      exit(-1);
+   }
+
+   /* ----------------------------------------------------------- *
+    * Main loop: wait for samples and fan them out, then service  *
+    * the sockets without blocking. The sample wait bounds the    *
+    * socket latency to 10ms when the sensors stop delivering.    *
+    * ----------------------------------------------------------- */
+   struct pollfd pfd[BNO_SUB_MAX + 1];
+   struct bnosample smp;
+   while(!stop) {
+      if(dump) {
+         dump = 0;
+         for(i = 0; i < acqcount; i++) bno_trace_dump(bno_acq_dev(acq, i), 2);
+      }
+      if(bno_acq_read(acq, &smp, 10) == 0) {
+         do distribute(&smp); while(bno_acq_read(acq, &smp, 0) == 0);
+      }
+
+      pfd[0].fd = lfd;
+      pfd[0].events = POLLIN;
+      for(i = 0; i < nclients; i++) {
+         pfd[i + 1].fd = clients[i].fd;
+         pfd[i + 1].events = POLLIN;
+      }
+      int n = nclients;
+      if(poll(pfd, n + 1, 0) <= 0) continue;
+
+      for(i = n - 1; i >= 0; i--) {
+         if(pfd[i + 1].revents == 0) continue;
+         if(client_recv(i) != 0) client_close(i);
+      }
+      if(pfd[0].revents & POLLIN) client_accept(lfd);
+   }
+
+   bno_acq_stop(acq);                 // workers done, counters settle
+   if(verbose == 1) printf("Debug: shutting down, %lu samples dropped, %lu overruns\n",
+                           bno_acq_dropped(acq), bno_acq_overruns(acq));
+   for(i = 0; verbose == 1 && bno_acq_dev(acq, i) != NULL; i++) {
+      fflush(stdout);
+      bno_errs_dump(bno_acq_dev(acq, i), 1);
+   }
+   while(nclients > 0) client_close(nclients - 1);
+   close(lfd);
+   unlink(sockpath);
+   bno_acq_close(acq);
+   exit(0);
+}
@@ -0,0 +1,496 @@
+/* ------------------------------------------------------------ *
+ * file:        cap_bno055.c                                    *
+ * purpose:     Binary capture files. The writer appends fixed  *
+ *              size records with the raw data registers, no    *
+ *              text formatting, through a large stdio buffer.  *
+ *              The file header keeps the sensor setup needed to*
+ *              decode them (units, mode, remap, calibration),  *
+ *              and periodic index records map the time to the  *
+ *              record slot. Readers mmap() the file and seek   *
+ *              by binary search over the index slots. Packed   *
+ *              captures store delta coded blocks instead, the  *
+ *              reader decodes them on access, see pack_bno055.c*
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "getbno055.h"
+
+_Static_assert(sizeof(struct bnorec) == 64, "capture record must be 64 bytes");
+_Static_assert(sizeof(struct bnocapidx) <= SNAPSHOT_BYTECOUNT, "index data too large");
+_Static_assert(sizeof(struct bnocaphdr) <= BNO_CAP_HDRSIZE, "capture header too large");
+_Static_assert(sizeof(struct bnopackblk) == 48, "packed block header must be 48 bytes");
+
+#define CAP_BUFSIZE (256 * 1024)       // stdio buffer, 4096 records
+
+struct bnocap{
+   FILE *fp;                           // capture file
+   struct bnocaphdr hdr;               // written before the first record
+   int  hdr_done;                      // header is in the file
+   uint64_t slots;                     // record slots written
+   uint64_t datarecs;                  // data records written
+   int  verbose;                       // debug flag
+   unsigned char *blk;                 // packed: block being filled
+   size_t blklen;                      // packed: bytes in blk, 0 = none
+   struct bnopack pk;                  // packed: encoder state
+};
+
+struct capblk{                         // packed block in the file
+   size_t off;                         // offset of its header
+   size_t end;                         // offset after its last record
+   long first;                         // number of its first record
+   long records;                       // records in the block
+   int64_t tstamp_ns;                  // sample time of the first one
+};
+
+struct bnocapfile{
+   const unsigned char *map;           // whole file, read-only
+   size_t size;                        // mapped bytes
+   const struct bnocaphdr *hdr;        // at the start of map
+   long slots;                         // complete record slots
+   struct capblk *blk;                 // packed: block table
+   long nblk;                          // packed: blocks in the table
+   long cur;                           // packed: record in rec, -1 = none
+   long curblk;                        // packed: block of cur
+   size_t curoff;                      // packed: offset after cur
+   struct bnopack pk;                  // packed: decoder state
+   struct bnorec rec;                  // packed: decoded record cur
+};
+
+static int64_t ts_ns(const struct timespec *ts) {
+   return (int64_t) ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_create() - start a capture file. hz is the recorded  *
+ * acquisition rate, for information only (0 = free running).   *
+ * encoding is BNO_CAP_RAW or BNO_CAP_PACKED.                   *
+ * ------------------------------------------------------------ */
+struct bnocap *bno_cap_create(const char *file, double hz, int encoding, int verbose) {
+   struct bnocap *cap = calloc(1, sizeof(struct bnocap));
+   if(cap == NULL) {
+      BNO_ERROR("Error: cannot allocate the capture writer.\n");
+      return(NULL);
+   }
+   if(encoding == BNO_CAP_PACKED) {
+      cap->blk = malloc(sizeof(struct bnopackblk) + BNO_CAP_INDEX_EVERY * BNO_PACK_RECMAX);
+      if(cap->blk == NULL) {
+         BNO_ERROR("Error: cannot allocate the capture writer.\n");
+         free(cap);
+         return(NULL);
+      }
+   }
+   if(! (cap->fp = fopen(file, "w"))) {
+      BNO_ERROR("Error: Can't open %s for writing.\n", file);
+      free(cap->blk);
+      free(cap);
+      return(NULL);
+   }
+   setvbuf(cap->fp, NULL, _IOFBF, CAP_BUFSIZE);
+   cap->verbose = verbose;
+
+   struct bnocaphdr *h = &cap->hdr;
+   memcpy(h->magic, BNO_CAP_MAGIC, sizeof(h->magic));
+   h->version     = BNO_CAP_VERSION;
+   h->hdrsize     = BNO_CAP_HDRSIZE;
+   h->recsize     = sizeof(struct bnorec);
+   h->index_every = BNO_CAP_INDEX_EVERY;
+   h->rate_mhz    = (uint32_t)(hz * 1000.0 + 0.5);
+   h->regstart    = SNAPSHOT_START;
+   h->reglen      = SNAPSHOT_BYTECOUNT;
+   h->encoding    = encoding;
+
+   struct timespec mono, real;
+   clock_gettime(CLOCK_MONOTONIC_RAW, &mono);
+   clock_gettime(CLOCK_REALTIME, &real);
+   h->start_mono_ns = ts_ns(&mono);
+   h->start_real_ns = ts_ns(&real);
+
+   BNO_DEBUG(verbose, "Debug: capture to [%s], %s\n", file,
+                           encoding == BNO_CAP_PACKED ? "delta packed" : "64 byte records");
+   return(cap);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_sensor() - record the setup of the next sensor index *
+ * in the header. Call for each sensor, in index order, before  *
+ * the first bno_cap_write(). Briefly switches the sensor to    *
+ * CONFIG mode to read the calibration set.                     *
+ * ------------------------------------------------------------ */
+int bno_cap_sensor(struct bnocap *cap, bno055_t *bno, const char *bus) {
+   if(cap->hdr_done || cap->hdr.nsensors == BNO_ACQ_MAX) {
+      BNO_ERROR("Error: cannot add a sensor to a running capture.\n");
+      return(-1);
+   }
+   struct bnocapsens *s = &cap->hdr.sens[cap->hdr.nsensors];
+   unsigned char calib = 0;
+
+   snprintf(s->bus, sizeof(s->bus), "%s", bus);
+   s->addr = bno->addr;
+
+   int mode = get_mode(bno);
+   int unit = bno_shadow_get(bno, 0, BNO055_UNIT_SEL_ADDR);
+   int conf = get_remap(bno, 'c');
+   int sign = get_remap(bno, 's');
+   if(mode < 0 || unit < 0 || conf < 0 || sign < 0) return(-1);
+   if(bno_read_regs(bno, BNO055_CALIB_STAT_ADDR, &calib, 1) != 0) return(-1);
+   if(get_calset(bno, s->calset) != 0) return(-1);
+
+   s->opr_mode = mode;
+   s->unit_sel = unit;
+   s->axr_conf = conf;
+   s->axr_sign = sign;
+   s->calib_st = calib;
+   cap->hdr.nsensors++;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_put() - append one record slot                           *
+ * ------------------------------------------------------------ */
+static int cap_put(struct bnocap *cap, const struct bnorec *rec) {
+   if(fwrite(rec, sizeof(struct bnorec), 1, cap->fp) != 1) {
+      BNO_ERROR("Error: capture write failed after %llu records.\n", (unsigned long long) cap->slots);
+      return(-1);
+   }
+   cap->slots++;
+   return(0);
+}
+
+static int cap_header(struct bnocap *cap) {
+   unsigned char block[BNO_CAP_HDRSIZE] = {0};
+   memcpy(block, &cap->hdr, sizeof(struct bnocaphdr));
+   if(fwrite(block, sizeof(block), 1, cap->fp) != 1) {
+      BNO_ERROR("Error: cannot write the capture header.\n");
+      return(-1);
+   }
+   cap->hdr_done = 1;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_index() - index data at the start of an index interval   *
+ * ------------------------------------------------------------ */
+static void cap_index(struct bnocap *cap, struct bnocapidx *idx, unsigned long dropped) {
+   struct timespec real;
+   clock_gettime(CLOCK_REALTIME, &real);
+   idx->realtime_ns = ts_ns(&real);
+   idx->datarecs    = cap->datarecs;
+   idx->dropped     = dropped;
+}
+
+/* ------------------------------------------------------------ *
+ * cap_flush() - write the packed block being filled, if any    *
+ * ------------------------------------------------------------ */
+static int cap_flush(struct bnocap *cap) {
+   if(cap->blklen == 0) return(0);
+   ((struct bnopackblk *) cap->blk)->bytes = cap->blklen;
+   if(fwrite(cap->blk, cap->blklen, 1, cap->fp) != 1) {
+      BNO_ERROR("Error: capture write failed after %llu records.\n", (unsigned long long) cap->slots);
+      return(-1);
+   }
+   cap->blklen = 0;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_pack() - add a data record to the packed block, starting *
+ * a block with keyframes at each index interval. Full blocks   *
+ * are written out, the one being filled stays in memory.       *
+ * ------------------------------------------------------------ */
+static int cap_pack(struct bnocap *cap, const struct bnorec *rec, unsigned long dropped) {
+   struct bnopackblk *b = (struct bnopackblk *) cap->blk;
+   if(cap->blklen == 0) {
+      memset(b, 0, sizeof(struct bnopackblk));
+      b->sync = BNO_PACK_SYNC;
+      b->tstamp_ns = rec->tstamp_ns;
+      cap_index(cap, &b->idx, dropped);
+      bno_pack_reset(&cap->pk, rec->tstamp_ns);
+      cap->blklen = sizeof(struct bnopackblk);
+   }
+   int len = bno_pack_rec(&cap->pk, rec, cap->blk + cap->blklen);
+   if(len < 0) {
+      BNO_ERROR("Error: invalid sensor index %d for the capture.\n", rec->sensor);
+      return(-1);
+   }
+   cap->blklen += len;
+   cap->slots++;
+   if(++b->records == BNO_CAP_INDEX_EVERY) return cap_flush(cap);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_write() - append a sample. At each index interval an *
+ * index record goes first, with the sample time, wall clock    *
+ * and dropped, the caller's count of samples lost so far. In   *
+ * packed captures the block header holds the index data.       *
+ * ------------------------------------------------------------ */
+int bno_cap_write(struct bnocap *cap, const struct bnosample *smp, unsigned long dropped) {
+   struct bnorec rec;
+   int64_t tstamp = ts_ns(&smp->snap.ts.tstamp);
+
+   if(!cap->hdr_done && cap_header(cap) != 0) return(-1);
+
+   memset(&rec, 0, sizeof(rec));
+   rec.tstamp_ns = tstamp;
+   rec.type      = BNO_REC_DATA;
+   rec.sensor    = smp->sensor;
+   rec.xfer_us   = smp->snap.ts.xfer_ns / 1000 > 0xFFFF ? 0xFFFF : smp->snap.ts.xfer_ns / 1000;
+   memcpy(rec.reg, smp->snap.raw, SNAPSHOT_BYTECOUNT);
+
+   if(cap->hdr.encoding == BNO_CAP_PACKED) {
+      if(cap_pack(cap, &rec, dropped) != 0) return(-1);
+      cap->datarecs++;
+      return(0);
+   }
+
+   if(cap->slots % BNO_CAP_INDEX_EVERY == 0) {
+      struct bnorec ir;
+      struct bnocapidx idx;
+      cap_index(cap, &idx, dropped);
+      memset(&ir, 0, sizeof(ir));
+      ir.tstamp_ns = tstamp;
+      ir.type      = BNO_REC_INDEX;
+      memcpy(ir.reg, &idx, sizeof(idx));
+      if(cap_put(cap, &ir) != 0) return(-1);
+   }
+   if(cap_put(cap, &rec) != 0) return(-1);
+   cap->datarecs++;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_close() - flush the buffer and close the file        *
+ * ------------------------------------------------------------ */
+int bno_cap_close(struct bnocap *cap) {
+   int res = 0;
+   if(cap == NULL) return(0);
+   if(!cap->hdr_done) res = cap_header(cap);
+   if(cap_flush(cap) != 0) res = -1;
+   if(fclose(cap->fp) != 0) {
+      BNO_ERROR("Error: capture file close failed.\n");
+      res = -1;
+   }
+   BNO_DEBUG(cap->verbose, "Debug: capture closed, %llu data records in %llu slots\n",
+                                (unsigned long long) cap->datarecs, (unsigned long long) cap->slots);
+   free(cap->blk);
+   free(cap);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_blocks() - build the block table of a packed capture by  *
+ * walking the block headers. A block that is incomplete at the *
+ * end of the file, e.g. after a crash, ends the table.         *
+ * ------------------------------------------------------------ */
+static int cap_blocks(struct bnocapfile *cf) {
+   size_t off = cf->hdr->hdrsize;
+   long first = 0, max = 0;
+
+   while(off + sizeof(struct bnopackblk) <= cf->size) {
+      struct bnopackblk b;
+      memcpy(&b, cf->map + off, sizeof(b));
+      if(b.sync != BNO_PACK_SYNC || b.bytes < sizeof(b) || b.bytes > cf->size - off) break;
+      if(cf->nblk == max) {
+         max = max ? 2 * max : 64;
+         struct capblk *t = realloc(cf->blk, max * sizeof(struct capblk));
+         if(t == NULL) {
+            BNO_ERROR("Error: cannot allocate the capture block table.\n");
+            return(-1);
+         }
+         cf->blk = t;
+      }
+      struct capblk *c = &cf->blk[cf->nblk++];
+      c->off       = off;
+      c->end       = off + b.bytes;
+      c->first     = first;
+      c->records   = b.records;
+      c->tstamp_ns = b.tstamp_ns;
+      first += b.records;
+      off   += b.bytes;
+   }
+   cf->slots = first;
+   cf->cur = -1;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_open() - map a capture file read-only. A record that *
+ * is still being written at the end of the file is ignored.    *
+ * ------------------------------------------------------------ */
+struct bnocapfile *bno_cap_open(const char *file) {
+   int fd = open(file, O_RDONLY | O_CLOEXEC);
+   if(fd < 0) {
+      BNO_ERROR("Error: Can't open %s for reading.\n", file);
+      return(NULL);
+   }
+   struct stat st;
+   if(fstat(fd, &st) != 0 || st.st_size < BNO_CAP_HDRSIZE) {
+      BNO_ERROR("Error: %s is not a capture file.\n", file);
+      close(fd);
+      return(NULL);
+   }
+   void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(map == MAP_FAILED) {
+      BNO_ERROR("Error: cannot map %s.\n", file);
+      return(NULL);
+   }
+
+   const struct bnocaphdr *h = map;
+   if(memcmp(h->magic, BNO_CAP_MAGIC, sizeof(h->magic)) != 0 || h->version != BNO_CAP_VERSION
+      || h->hdrsize != BNO_CAP_HDRSIZE || h->recsize != sizeof(struct bnorec)
+      || h->regstart != SNAPSHOT_START || h->reglen != SNAPSHOT_BYTECOUNT
+      || h->index_every == 0 || h->nsensors > BNO_ACQ_MAX || h->encoding > BNO_CAP_PACKED) {
+      BNO_ERROR("Error: %s is not a capture file of this version.\n", file);
+      munmap(map, st.st_size);
+      return(NULL);
+   }
+
+   struct bnocapfile *cf = calloc(1, sizeof(struct bnocapfile));
+   if(cf == NULL) {
+      munmap(map, st.st_size);
+      return(NULL);
+   }
+   cf->map   = map;
+   cf->size  = st.st_size;
+   cf->hdr   = h;
+   cf->slots = (st.st_size - h->hdrsize) / h->recsize;
+   if(h->encoding == BNO_CAP_PACKED && cap_blocks(cf) != 0) {
+      bno_cap_unmap(cf);
+      return(NULL);
+   }
+   return(cf);
+}
+
+const struct bnocaphdr *bno_cap_header(struct bnocapfile *cf) {
+   return(cf->hdr);
+}
+
+long bno_cap_slots(struct bnocapfile *cf) {
+   return(cf->slots);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_unpack() - decode record n of a packed capture. The next *
+ * record continues from the previous one, anything else starts *
+ * over at the keyframes of the block holding n.                *
+ * ------------------------------------------------------------ */
+static const struct bnorec *cap_unpack(struct bnocapfile *cf, long n) {
+   if(n == cf->cur) return(&cf->rec);
+
+   const struct capblk *b = &cf->blk[cf->curblk];
+   if(cf->cur < 0 || n < cf->cur || n >= b->first + b->records) {
+      long lo = 0, hi = cf->nblk - 1;
+      while(lo < hi) {
+         long mid = (lo + hi + 1) / 2;
+         if(cf->blk[mid].first <= n) lo = mid;
+         else hi = mid - 1;
+      }
+      b = &cf->blk[lo];
+      cf->curblk = lo;
+      cf->cur    = b->first - 1;
+      cf->curoff = b->off + sizeof(struct bnopackblk);
+      bno_pack_reset(&cf->pk, b->tstamp_ns);
+   }
+   while(cf->cur < n) {
+      int used = bno_unpack_rec(&cf->pk, cf->map + cf->curoff, b->end - cf->curoff, &cf->rec);
+      if(used < 0) {
+         BNO_ERROR("Error: corrupt capture block at offset %zu.\n", b->off);
+         cf->cur = -1;
+         return(NULL);
+      }
+      cf->curoff += used;
+      cf->cur++;
+   }
+   return(&cf->rec);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_rec() - record slot n, NULL if out of range. For a   *
+ * packed capture it is decoded, and only valid until the next  *
+ * call for this file. Reading in order is fastest then.        *
+ * ------------------------------------------------------------ */
+const struct bnorec *bno_cap_rec(struct bnocapfile *cf, long n) {
+   if(n < 0 || n >= cf->slots) return(NULL);
+   if(cf->hdr->encoding == BNO_CAP_PACKED) return cap_unpack(cf, n);
+   return (const struct bnorec *)(cf->map + cf->hdr->hdrsize + (size_t) n * cf->hdr->recsize);
+}
+
+/* ------------------------------------------------------------ *
+ * cap_mark() - first slot and sample time of index interval k, *
+ * the index slot or the packed block                           *
+ * ------------------------------------------------------------ */
+static long cap_mark(struct bnocapfile *cf, long k, int64_t *tstamp_ns) {
+   if(cf->hdr->encoding == BNO_CAP_PACKED) {
+      *tstamp_ns = cf->blk[k].tstamp_ns;
+      return(cf->blk[k].first);
+   }
+   *tstamp_ns = bno_cap_rec(cf, k * cf->hdr->index_every)->tstamp_ns;
+   return(k * cf->hdr->index_every);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_seek() - first data slot with a sample time at or    *
+ * after tstamp_ns (CLOCK_MONOTONIC_RAW), bno_cap_slots() if    *
+ * there is none. Binary search over the index slots or packed *
+ * blocks, then a scan of at most one index interval.           *
+ * ------------------------------------------------------------ */
+long bno_cap_seek(struct bnocapfile *cf, int64_t tstamp_ns) {
+   long every = cf->hdr->index_every;
+   long lo = 0, hi = (cf->slots + every - 1) / every - 1;
+   int64_t t;
+
+   if(cf->hdr->encoding == BNO_CAP_PACKED) hi = cf->nblk - 1;
+   if(hi < 0) return(cf->slots);
+   while(lo < hi) {
+      long mid = (lo + hi + 1) / 2;
+      cap_mark(cf, mid, &t);
+      if(t <= tstamp_ns) lo = mid;
+      else hi = mid - 1;
+   }
+
+   long n;
+   for(n = cap_mark(cf, lo, &t); n < cf->slots; n++) {
+      const struct bnorec *r = bno_cap_rec(cf, n);
+      if(r == NULL) return(cf->slots);
+      if(r->type == BNO_REC_DATA && r->tstamp_ns >= tstamp_ns) break;
+   }
+   return(n);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_sample() - decode data slot n into smp, with the     *
+ * same scaling as a live get_snapshot(). Returns -1 for index  *
+ * slots and out of range.                                      *
+ * ------------------------------------------------------------ */
+int bno_cap_sample(struct bnocapfile *cf, long n, struct bnosample *smp) {
+   const struct bnorec *r = bno_cap_rec(cf, n);
+   if(r == NULL || r->type != BNO_REC_DATA) return(-1);
+
+   memset(smp, 0, sizeof(struct bnosample));
+   bno_snap_decode(r->reg, &smp->snap);
+   smp->sensor = r->sensor;
+   smp->snap.ts.tstamp.tv_sec  = r->tstamp_ns / 1000000000LL;
+   smp->snap.ts.tstamp.tv_nsec = r->tstamp_ns % 1000000000LL;
+   smp->snap.ts.xfer_ns = (long) r->xfer_us * 1000;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_cap_unmap() - release a mapped capture file              *
+ * ------------------------------------------------------------ */
+void bno_cap_unmap(struct bnocapfile *cf) {
+   if(cf == NULL) return;
+   munmap((void *) cf->map, cf->size);
+   free(cf->blk);
+   free(cf);
+}
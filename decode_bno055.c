@@ -0,0 +1,312 @@
+/* ------------------------------------------------------------ *
+ * file:        decode_bno055.c                                 *
+ * purpose:     Batch decoder for arrays of raw data register   *
+ *              blocks 0x08-0x3B, as in capture records or      *
+ *              bnosnap.raw, into one float array per channel.  *
+ *              Eight samples are decoded at once: their int16  *
+ *              registers are transposed 8x8 in vector regs so  *
+ *              every channel comes out as 8 contiguous values, *
+ *              then converted and scaled. SSE2 or AVX2 on x86, *
+ *              NEON on 64-bit ARM, else the scalar loop. The   *
+ *              results are bit identical to (float) of the     *
+ *              get_ functions' double values, for all inputs.  *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "getbno055.h"
+
+#if defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__))
+#define DEC_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define DEC_NEON 1
+#include <arm_neon.h>
+#endif
+
+#define DEC_UNIT_OFF (BNO055_UNIT_SEL_ADDR - SNAPSHOT_START)
+
+/* ------------------------------------------------------------ *
+ * Scale factors. Except linear acceleration and gravity at 100 *
+ * LSB per m/s2, every divisor of bno_raw_div() has an exact    *
+ * float reciprocal (1/1.6 = 0.625), so a multiply rounds like  *
+ * the double division followed by a float conversion. For 100 *
+ * only a float division does, a multiply by 0.01f differs for  *
+ * about a quarter of the int16 values.                         *
+ * ------------------------------------------------------------ */
+static float dec_mul[24];     // reciprocals of channels 0-15, 1.0 for 16-23
+static float dec_div[2][24];  // channels 16-21 divisors by UNIT_SEL bit-0
+
+static void dec_init() {
+   int ch;
+   for(ch = 0; ch < 24; ch++) {
+      dec_mul[ch] = ch < BNO_CH_LIN ? (float)(1.0 / bno_raw_div(ch, 0)) : 1.0f;
+      dec_div[0][ch] = ch < BNO_RAW_CHANNELS ? (float) bno_raw_div(ch, 0) : 1.0f;
+      dec_div[1][ch] = ch < BNO_RAW_CHANNELS ? (float) bno_raw_div(ch, 1) : 1.0f;
+      if(ch < BNO_CH_LIN) dec_div[0][ch] = dec_div[1][ch] = 1.0f;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * dec_scalar() - samples from..n-1 one by one, the tail of the *
+ * vector loops and the decoder without SIMD support            *
+ * ------------------------------------------------------------ */
+static void dec_scalar(const unsigned char *regs, int stride, int from, int n, float **out) {
+   int i, ch;
+   for(i = from; i < n; i++) {
+      const unsigned char *r = regs + (size_t) i * stride;
+      int u = r[DEC_UNIT_OFF] & 0x01;
+      for(ch = 0; ch < BNO_RAW_CHANNELS; ch++) {
+         if(out[ch] == NULL) continue;
+         float v = (float)(int16_t)((r[2*ch+1] << 8) | r[2*ch]);
+         out[ch][i] = ch < BNO_CH_LIN ? v * dec_mul[ch] : v / dec_div[u][ch];
+      }
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * dec_units() - UNIT_SEL bit-0 of samples i..i+7 if they all   *
+ * agree, else -1 and the chunk goes to dec_scalar()            *
+ * ------------------------------------------------------------ */
+static int dec_units(const unsigned char *regs, int stride, int i) {
+   int k, u = regs[(size_t) i * stride + DEC_UNIT_OFF] & 0x01;
+   for(k = 1; k < 8; k++)
+      if((regs[(size_t)(i + k) * stride + DEC_UNIT_OFF] & 0x01) != u) return(-1);
+   return(u);
+}
+
+#ifdef DEC_X86
+/* ------------------------------------------------------------ *
+ * dec_transpose_sse2() - 8 rows of 8 int16 (row k = sample k,  *
+ * the channels of a 16 byte register group) into 8 columns     *
+ * (column c = channel c of the 8 samples)                      *
+ * ------------------------------------------------------------ */
+static inline void dec_transpose_sse2(__m128i *r) {
+   __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]);
+   __m128i t1 = _mm_unpackhi_epi16(r[0], r[1]);
+   __m128i t2 = _mm_unpacklo_epi16(r[2], r[3]);
+   __m128i t3 = _mm_unpackhi_epi16(r[2], r[3]);
+   __m128i t4 = _mm_unpacklo_epi16(r[4], r[5]);
+   __m128i t5 = _mm_unpackhi_epi16(r[4], r[5]);
+   __m128i t6 = _mm_unpacklo_epi16(r[6], r[7]);
+   __m128i t7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+   __m128i u0 = _mm_unpacklo_epi32(t0, t2);
+   __m128i u1 = _mm_unpackhi_epi32(t0, t2);
+   __m128i u2 = _mm_unpacklo_epi32(t1, t3);
+   __m128i u3 = _mm_unpackhi_epi32(t1, t3);
+   __m128i u4 = _mm_unpacklo_epi32(t4, t6);
+   __m128i u5 = _mm_unpackhi_epi32(t4, t6);
+   __m128i u6 = _mm_unpacklo_epi32(t5, t7);
+   __m128i u7 = _mm_unpackhi_epi32(t5, t7);
+
+   r[0] = _mm_unpacklo_epi64(u0, u4);
+   r[1] = _mm_unpackhi_epi64(u0, u4);
+   r[2] = _mm_unpacklo_epi64(u1, u5);
+   r[3] = _mm_unpackhi_epi64(u1, u5);
+   r[4] = _mm_unpacklo_epi64(u2, u6);
+   r[5] = _mm_unpackhi_epi64(u2, u6);
+   r[6] = _mm_unpacklo_epi64(u3, u7);
+   r[7] = _mm_unpackhi_epi64(u3, u7);
+}
+
+/* ------------------------------------------------------------ *
+ * dec_load() - register group g (channels 8g..8g+7) of samples *
+ * i..i+7. Group 2 reads 0x28-0x37, still inside the block.     *
+ * ------------------------------------------------------------ */
+static inline void dec_load(const unsigned char *regs, int stride, int i, int g, __m128i *r) {
+   int k;
+   for(k = 0; k < 8; k++)
+      r[k] = _mm_loadu_si128((const __m128i *)(regs + (size_t)(i + k) * stride + 16 * g));
+}
+
+static void dec_sse2(const unsigned char *regs, int stride, int n, float **out) {
+   int i = 0, g, c;
+   for(; i + 8 <= n; i += 8) {
+      int u = dec_units(regs, stride, i);
+      if(u < 0) {
+         dec_scalar(regs, stride, i, i + 8, out);
+         continue;
+      }
+      for(g = 0; g < 3; g++) {
+         __m128i r[8];
+         dec_load(regs, stride, i, g, r);
+         dec_transpose_sse2(r);
+         for(c = 0; c < 8; c++) {
+            int ch = 8 * g + c;
+            if(ch >= BNO_RAW_CHANNELS || out[ch] == NULL) continue;
+            __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(r[c], r[c]), 16));
+            __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(r[c], r[c]), 16));
+            if(ch < BNO_CH_LIN) {
+               __m128 m = _mm_set1_ps(dec_mul[ch]);
+               lo = _mm_mul_ps(lo, m);
+               hi = _mm_mul_ps(hi, m);
+            }
+            else {
+               __m128 d = _mm_set1_ps(dec_div[u][ch]);
+               lo = _mm_div_ps(lo, d);
+               hi = _mm_div_ps(hi, d);
+            }
+            _mm_storeu_ps(out[ch] + i, lo);
+            _mm_storeu_ps(out[ch] + i + 4, hi);
+         }
+      }
+   }
+   dec_scalar(regs, stride, i, n, out);
+}
+
+/* ------------------------------------------------------------ *
+ * dec_avx2() - the same transpose, AVX2 widens and converts a  *
+ * whole column of 8 values with one instruction each           *
+ * ------------------------------------------------------------ */
+__attribute__((target("avx2")))
+static void dec_avx2(const unsigned char *regs, int stride, int n, float **out) {
+   int i = 0, g, c;
+   for(; i + 8 <= n; i += 8) {
+      int u = dec_units(regs, stride, i);
+      if(u < 0) {
+         dec_scalar(regs, stride, i, i + 8, out);
+         continue;
+      }
+      for(g = 0; g < 3; g++) {
+         __m128i r[8];
+         dec_load(regs, stride, i, g, r);
+         dec_transpose_sse2(r);
+         for(c = 0; c < 8; c++) {
+            int ch = 8 * g + c;
+            if(ch >= BNO_RAW_CHANNELS || out[ch] == NULL) continue;
+            __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(r[c]));
+            if(ch < BNO_CH_LIN) v = _mm256_mul_ps(v, _mm256_set1_ps(dec_mul[ch]));
+            else v = _mm256_div_ps(v, _mm256_set1_ps(dec_div[u][ch]));
+            _mm256_storeu_ps(out[ch] + i, v);
+         }
+      }
+   }
+   dec_scalar(regs, stride, i, n, out);
+}
+#endif
+
+#ifdef DEC_NEON
+/* ------------------------------------------------------------ *
+ * dec_neon() - 8x8 int16 transpose with vtrn, 64-bit ARM only: *
+ * ARMv7 NEON has no float division for the 100 LSB channels.   *
+ * ------------------------------------------------------------ */
+static void dec_neon(const unsigned char *regs, int stride, int n, float **out) {
+   int i = 0, g, c, k;
+   for(; i + 8 <= n; i += 8) {
+      int u = dec_units(regs, stride, i);
+      if(u < 0) {
+         dec_scalar(regs, stride, i, i + 8, out);
+         continue;
+      }
+      for(g = 0; g < 3; g++) {
+         int16x8_t r[8], col[8];
+         for(k = 0; k < 8; k++)
+            r[k] = vreinterpretq_s16_u8(vld1q_u8(regs + (size_t)(i + k) * stride + 16 * g));
+
+         int16x8x2_t t0 = vtrnq_s16(r[0], r[1]);
+         int16x8x2_t t1 = vtrnq_s16(r[2], r[3]);
+         int16x8x2_t t2 = vtrnq_s16(r[4], r[5]);
+         int16x8x2_t t3 = vtrnq_s16(r[6], r[7]);
+         int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+         int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+         int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+         int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+         col[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[0]), vget_low_s32(u2.val[0])));
+         col[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[0]), vget_low_s32(u3.val[0])));
+         col[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[1]), vget_low_s32(u2.val[1])));
+         col[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[1]), vget_low_s32(u3.val[1])));
+         col[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u2.val[0])));
+         col[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u3.val[0])));
+         col[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u2.val[1])));
+         col[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u3.val[1])));
+
+         for(c = 0; c < 8; c++) {
+            int ch = 8 * g + c;
+            if(ch >= BNO_RAW_CHANNELS || out[ch] == NULL) continue;
+            float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(col[c])));
+            float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(col[c])));
+            if(ch < BNO_CH_LIN) {
+               lo = vmulq_n_f32(lo, dec_mul[ch]);
+               hi = vmulq_n_f32(hi, dec_mul[ch]);
+            }
+            else {
+               float32x4_t d = vdupq_n_f32(dec_div[u][ch]);
+               lo = vdivq_f32(lo, d);
+               hi = vdivq_f32(hi, d);
+            }
+            vst1q_f32(out[ch] + i, lo);
+            vst1q_f32(out[ch] + i + 4, hi);
+         }
+      }
+   }
+   dec_scalar(regs, stride, i, n, out);
+}
+#endif
+
+static void dec_scalar_all(const unsigned char *regs, int stride, int n, float **out) {
+   dec_scalar(regs, stride, 0, n, out);
+}
+
+static const char *dec_names[] = { "auto", "scalar", "sse2", "avx2", "neon" };
+static void (*dec_fn)(const unsigned char*, int, int, float**) = NULL;
+static int dec_impl = BNO_DEC_AUTO;
+
+/* ------------------------------------------------------------ *
+ * bno_decode_select() - pick the decoder, BNO_DEC_AUTO for the *
+ * best this CPU supports. Returns -1 if impl is not available. *
+ * ------------------------------------------------------------ */
+int bno_decode_select(int impl) {
+   if(dec_mul[0] == 0) dec_init();
+   if(impl == BNO_DEC_AUTO) {
+#ifdef DEC_X86
+      __builtin_cpu_init();
+      impl = __builtin_cpu_supports("avx2") ? BNO_DEC_AVX2 : BNO_DEC_SSE2;
+#elif defined(DEC_NEON)
+      impl = BNO_DEC_NEON;
+#else
+      impl = BNO_DEC_SCALAR;
+#endif
+   }
+   switch(impl) {
+      case BNO_DEC_SCALAR: dec_fn = dec_scalar_all; break;
+#ifdef DEC_X86
+      case BNO_DEC_SSE2: dec_fn = dec_sse2; break;
+      case BNO_DEC_AVX2:
+         __builtin_cpu_init();
+         if(!__builtin_cpu_supports("avx2")) return(-1);
+         dec_fn = dec_avx2;
+         break;
+#endif
+#ifdef DEC_NEON
+      case BNO_DEC_NEON: dec_fn = dec_neon; break;
+#endif
+      default: return(-1);
+   }
+   dec_impl = impl;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_decode_name() - name of the decoder in use               *
+ * ------------------------------------------------------------ */
+const char *bno_decode_name() {
+   if(dec_fn == NULL) bno_decode_select(BNO_DEC_AUTO);
+   return(dec_names[dec_impl]);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_decode_batch() - decode n register blocks, the first at  *
+ * regs, the next stride bytes further (SNAPSHOT_BYTECOUNT for  *
+ * packed arrays, sizeof(struct bnorec) for capture records).   *
+ * out[ch] receives the n values of channel ch in units, NULL   *
+ * entries are skipped. Not thread safe on the very first call. *
+ * ------------------------------------------------------------ */
+void bno_decode_batch(const unsigned char *regs, int stride, int n, float **out) {
+   if(dec_fn == NULL) bno_decode_select(BNO_DEC_AUTO);
+   dec_fn(regs, stride, n, out);
+}
@@ -18,6 +18,7 @@
 #include <ctype.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
 #include <getopt.h>
 #include <time.h>
 #include "getbno055.h"
@@ -25,7 +26,7 @@
 /* ------------------------------------------------------------ *
  * Global variables and defaults                                *
  * ------------------------------------------------------------ */
-int verbose = 0;
+int verbose = 0; // debug flag, 0 = normal, 1 = debug mode
 int outflag = 0;
 int argflag = 0; // 1 dump, 2 reset, 3 load calib, 4 write calib
 char opr_mode[9] = {0};
@@ -35,16 +36,35 @@ char senaddr[256] = "0x28";
 char i2c_bus[256] = I2CBUS;
 char htmfile[256];
 char calfile[256];
+char acqsens[BNO_ACQ_MAX][256]; // -s multi-sensor list, bus@addr
+int acqcount = 0;
+long samples = 0;               // -n sample count, 0 = endless
+char irqline[256];              // -i INT pin GPIO line, or "sim"
+double rate = 0;                // -f sample rate in Hz, 0 = default
+char shmpub[256];               // -P shared memory name to publish to
+char shmread[256];              // -R shared memory name to read from
+char daemonsock[108];           // -D bno055d socket to subscribe to
+char capfile[256];              // -C binary capture file to write
+char capread[256];              // -X binary capture file to print
+int capenc = BNO_CAP_RAW;       // -z packed capture encoding
+int outfmt = BNO_OUT_TEXT;      // -F sample output format
+double deadband = 0;            // -e HTML update deadband, data units
+double htmlhz = BNO_HTML_HZ;    // -u max HTML file writes per second
+int tracelen = 0;               // -T bus transactions to trace, 0 = off
+bno055_t *tracebno = NULL;      // traced single sensor handle
 
 /* ------------------------------------------------------------ *
  * print_usage() prints the programs commandline instructions.  *
  * ------------------------------------------------------------ */
 void usage() {
-   static char const usage[] = "Usage: getbno055 [-a hex i2c-addr] [-m <opr_mode>] [-t acc|gyr|mag|eul|qua|lin|gra|inf|cal] [-r] [-w calfile] [-l calfile] [-o htmlfile] [-v]\n\
+   static char const usage[] = "Usage: getbno055 [-a hex i2c-addr] [-m <opr_mode>] [-t acc|gyr|mag|eul|qua|lin|gra|snp|inf|cal] [-r] [-w calfile] [-l calfile] [-o htmlfile] [-e deadband] [-u hz] [-F format] [-s bus@addr] [-n count] [-f hz] [-i gpio] [-P shm] [-R shm] [-D socket] [-C capfile] [-z] [-X capfile] [-T n] [-v]\n\
 \n\
 Command line parameters have the following format:\n\
    -a   sensor I2C bus address in hex, Example: -a 0x28 (default)\n\
-   -b   I2C bus to query, Example: -b /dev/i2c-1 (default)\n\
+   -b   I2C bus to query, Example: -b /dev/i2c-1 (default), -b sim (simulated sensor)\n\
+        or the serial port for UART mode, Example: -b /dev/serial0\n\
+        or a capture file to replay, as fast as possible or in real time,\n\
+        Example: -b replay:./imu.cap, -b replay-rt:./imu.cap\n\
    -d   dump the complete sensor register map content\n\
    -m   set sensor operational mode. mode arguments:\n\
            config   = configuration mode\n\
@@ -73,12 +93,37 @@ Command line parameters have the following format:\n\
            qua = Orientation Q (W-X-Y-Z values as Quaternation)\n\
            gra = GravityVector (X-Y-Z axis values)\n\
            lin = Linear Accel (X-Y-Z axis values)\n\
+           snp = Snapshot of all data values, read in one burst\n\
            inf = Sensor info (23 version and state values)\n\
            cal = Calibration data (mag, gyro and accel calibration values)\n\
-           continuous = continuous data-eul)\n\
+           continuous = continuous data-eul, with -i interrupt driven\n\
    -l   load sensor calibration data from file, Example -l ./bno055.cal\n\
    -w   write sensor calibration data to file, Example -w ./bno055.cal\n\
    -o   output sensor data to HTML table file, requires -t, Example: -o ./bno055.html\n\
+        replaced atomically, -t continuous only writes it when the data changed\n\
+   -e   -o deadband for -t continuous, min value change to rewrite, Example: -e 0.5\n\
+   -u   -o max writes per second for -t continuous, 0 = no limit, Example: -u 0.2 (default 1)\n\
+   -F   output format of -t, -s, -X, -R and -D data: text (default), csv,\n\
+        json (JSON Lines) or bin (bno055d frames), Example: -F csv\n\
+   -s   multi-sensor acquisition, repeat for up to 8 sensors, one thread per bus.\n\
+        Prints one time-stamped snapshot line per sample, Example: -s /dev/i2c-0@0x28\n\
+   -n   number of samples for -s and -t continuous, 0 = endless (default)\n\
+   -f   sample rate in Hz for -t continuous (default 1, max 100 = fusion rate)\n\
+        and -s (default 100, max 1000 for raw data modes), Example: -f 50\n\
+   -i   INT pin GPIO line for -t continuous, reads data only after a sensor\n\
+        motion interrupt. Example: -i gpiochip0:17, -i sim for the simulator\n\
+   -P   publish the -s samples to POSIX shared memory instead of printing them,\n\
+        newest sample per sensor. Example: -P /bno055\n\
+   -R   print the newest samples from a -P publisher, without bus access\n\
+   -D   subscribe to a bno055d daemon instead of opening the bus, print all\n\
+        fields at the -f rate (whole Hz, min 1) for -n samples.\n\
+        Example: -D /tmp/bno055.sock\n\
+   -C   write the -s samples to a binary capture file instead of printing them,\n\
+        raw registers with timestamps, 64 bytes per sample. Example: -C ./imu.cap\n\
+   -z   pack the -C capture with delta + varint coding, several times smaller\n\
+   -X   print the samples of a binary capture file, up to -n samples\n\
+   -T   trace the last n bus transactions of each sensor, print them to stderr at\n\
+        the end, with the duration and result of each. Example: -T 64\n\
    -h   display this message\n\
    -v   enable debug output\n\
 \n\
@@ -89,7 +134,17 @@ Usage examples:\n\
 ./getbno055 -t cal -v\n\
 ./getbno055 -t eul -o ./bno055.html\n\
 ./getbno055 -m ndof\n\
-./getbno055 -w ./bno055.cal\n";
+./getbno055 -w ./bno055.cal\n\
+./getbno055 -s /dev/i2c-0@0x28 -s /dev/i2c-1@0x28 -s /dev/i2c-1@0x29 -n 1000\n\
+./getbno055 -t continuous -f 100 -n 6000\n\
+./getbno055 -t continuous -f 10 -o /var/www/html/bno055.html -e 0.5 -u 0.2\n\
+./getbno055 -t continuous -i gpiochip0:17\n\
+./getbno055 -s /dev/i2c-1@0x28 -P /bno055\n\
+./getbno055 -R /bno055\n\
+./getbno055 -D /tmp/bno055.sock -f 10 -n 100\n\
+./getbno055 -s /dev/i2c-1@0x28 -C ./imu.cap\n\
+./getbno055 -X ./imu.cap -n 10\n\
+./getbno055 -s /dev/i2c-1@0x28 -F json | jq .eul_head\n";
    printf(usage);
 }
 
@@ -102,7 +157,7 @@ void parseargs(int argc, char* argv[]) {
 
    if(argc == 1) { usage(); exit(-1); }
 
-   while ((arg = (int) getopt (argc, argv, "a:b:dm:p:rt:l:w:o:hv")) != -1) {
+   while ((arg = (int) getopt (argc, argv, "a:b:dm:p:rt:l:w:o:F:e:u:s:n:f:i:P:R:D:C:X:T:zhv")) != -1) {
       switch (arg) {
          // arg -v verbose, type: flag, optional
          case 'v':
@@ -168,7 +223,7 @@ void parseargs(int argc, char* argv[]) {
          // mandatory, example: mag (magnetometer)
          case 't':
             if(verbose == 1) printf("Debug: arg -t, value %s\n", optarg);
-            if (strlen(optarg) != 3) {
+            if (strlen(optarg) != 3 && strcmp(optarg, "continuous") != 0) {
                printf("Error: Cannot get valid -t data type argument.\n");
                exit(-1);
             }
@@ -211,6 +266,155 @@ void parseargs(int argc, char* argv[]) {
             strncpy(htmfile, optarg, sizeof(htmfile));
             break;
 
+         // arg -e + HTML deadband, type: number, -t continuous -o
+         // rewrite the file only if a value moves more. example: 0.5
+         case 'e':
+            if(verbose == 1) printf("Debug: arg -e, value %s\n", optarg);
+            deadband = strtod(optarg, NULL);
+            if(deadband < 0) {
+               printf("Error: invalid -e deadband argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -u + max HTML writes/s, type: number, -t continuous -o
+         // 0 = no limit. example: 0.2 (every 5s at most)
+         case 'u':
+            if(verbose == 1) printf("Debug: arg -u, value %s\n", optarg);
+            htmlhz = strtod(optarg, NULL);
+            if(htmlhz < 0) {
+               printf("Error: invalid -u update rate argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -F + output format, type: string
+         // text (default), csv, json, bin. example: csv
+         case 'F':
+            if(verbose == 1) printf("Debug: arg -F, value %s\n", optarg);
+            outfmt = bno_out_format(optarg);
+            if(outfmt < 0) {
+               printf("Error: invalid -F output format %s.\n", optarg);
+               exit(-1);
+            }
+            break;
+
+         // arg -s + sensor bus@addr, type: string, repeatable
+         // multi-sensor acquisition. example: /dev/i2c-1@0x28
+         case 's':
+            if(verbose == 1) printf("Debug: arg -s, value %s\n", optarg);
+            if (acqcount == BNO_ACQ_MAX || strlen(optarg) >= sizeof(acqsens[0])
+                || strchr(optarg, '@') == NULL) {
+               printf("Error: invalid -s sensor argument.\n");
+               exit(-1);
+            }
+            strncpy(acqsens[acqcount++], optarg, sizeof(acqsens[0]));
+            break;
+
+         // arg -n + sample count, type: number, used with -s
+         case 'n':
+            if(verbose == 1) printf("Debug: arg -n, value %s\n", optarg);
+            samples = strtol(optarg, NULL, 10);
+            if(samples < 0) {
+               printf("Error: invalid -n sample count argument.\n");
+               exit(-1);
+            }
+            break;
+
+         // arg -f + sample rate in Hz, type: number
+         // used with -t continuous and -s, example: 50
+         case 'f':
+            if(verbose == 1) printf("Debug: arg -f, value %s\n", optarg);
+            rate = strtod(optarg, NULL);
+            if(rate <= 0 || rate > BNO_TICK_MAX_HZ) {
+               printf("Error: invalid -f sample rate argument, max %d Hz.\n", BNO_TICK_MAX_HZ);
+               exit(-1);
+            }
+            break;
+
+         // arg -i + INT pin GPIO line, type: string, used with -t continuous
+         // example: gpiochip0:17, or sim for the simulated sensor
+         case 'i':
+            if(verbose == 1) printf("Debug: arg -i, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(irqline)) {
+               printf("Error: invalid -i GPIO line argument.\n");
+               exit(-1);
+            }
+            strncpy(irqline, optarg, sizeof(irqline));
+            break;
+
+         // arg -P + shared memory name, type: string, used with -s
+         // example: /bno055
+         case 'P':
+            if(verbose == 1) printf("Debug: arg -P, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(shmpub)) {
+               printf("Error: invalid -P shared memory argument.\n");
+               exit(-1);
+            }
+            strncpy(shmpub, optarg, sizeof(shmpub));
+            break;
+
+         // arg -R + shared memory name, type: string
+         // example: /bno055
+         case 'R':
+            if(verbose == 1) printf("Debug: arg -R, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(shmread)) {
+               printf("Error: invalid -R shared memory argument.\n");
+               exit(-1);
+            }
+            strncpy(shmread, optarg, sizeof(shmread));
+            break;
+
+         // arg -D + bno055d socket path, type: string
+         // example: /tmp/bno055.sock
+         case 'D':
+            if(verbose == 1) printf("Debug: arg -D, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(daemonsock)) {
+               printf("Error: invalid -D socket argument.\n");
+               exit(-1);
+            }
+            strncpy(daemonsock, optarg, sizeof(daemonsock));
+            break;
+
+         // arg -z packed capture, type: flag, used with -C
+         case 'z':
+            if(verbose == 1) printf("Debug: arg -z, value packed\n");
+            capenc = BNO_CAP_PACKED;
+            break;
+
+         // arg -C + capture file, type: string, used with -s
+         // example: ./imu.cap
+         case 'C':
+            if(verbose == 1) printf("Debug: arg -C, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(capfile)) {
+               printf("Error: invalid -C capture file argument.\n");
+               exit(-1);
+            }
+            strncpy(capfile, optarg, sizeof(capfile));
+            break;
+
+         // arg -X + capture file, type: string
+         // example: ./imu.cap
+         case 'X':
+            if(verbose == 1) printf("Debug: arg -X, value %s\n", optarg);
+            if (strlen(optarg) >= sizeof(capread)) {
+               printf("Error: invalid -X capture file argument.\n");
+               exit(-1);
+            }
+            strncpy(capread, optarg, sizeof(capread));
+            break;
+
+         // arg -T + trace ring size, type: number
+         // example: 64
+         case 'T':
+            if(verbose == 1) printf("Debug: arg -T, value %s\n", optarg);
+            tracelen = atoi(optarg);
+            if(tracelen < 1 || tracelen > 1 << 24) {
+               printf("Error: invalid -T trace length argument, 1..%d.\n", 1 << 24);
+               exit(-1);
+            }
+            break;
+
          // arg -h usage, type: flag, optional
          case 'h':
             usage(); exit(0);
@@ -235,12 +439,12 @@ void parseargs(int argc, char* argv[]) {
 /* ----------------------------------------------------------- *
  *  print_calstat() - Read and print calibration status        *
  * ----------------------------------------------------------- */
-void print_calstat() {
+void print_calstat(bno055_t *bno) {
    struct bnocal bnoc;
    /* -------------------------------------------------------- *
     *  Check the sensors calibration state                     *
     * -------------------------------------------------------- */
-   int res = get_calstatus(&bnoc);
+   int res = get_calstatus(bno, &bnoc);
    if(res != 0) {
       printf("Error: Cannot read calibration state.\n");
       exit(-1);
@@ -314,6 +518,253 @@ void print_calstat() {
    }
 }
 
+/* ----------------------------------------------------------- *
+ *  print_data() - "-t" output of one read: the fields through  *
+ *  the -F format to stdout, with -o also as a HTML table.      *
+ * ----------------------------------------------------------- */
+int print_data(const struct bnosnap *d, uint16_t fields) {
+   struct bnosample smp;
+   memset(&smp, 0, sizeof(smp));
+   smp.snap = *d;
+
+   struct bnoout *out = bno_out_open(STDOUT_FILENO, outfmt, fields);
+   if(out == NULL) return(-1);
+   int res = bno_out_sample(out, &smp);
+   if(bno_out_close(out) != 0) res = -1;
+   if(res == 0 && outflag == 1) res = bno_out_html(htmfile, d, fields);
+   return(res);
+}
+
+/* ----------------------------------------------------------- *
+ *  acq_close() - print the "-T" traces, then close the sensors *
+ * ----------------------------------------------------------- */
+static void acq_close(struct bnoacq *acq) {
+   int i;
+   for(i = 0; tracelen > 0 && i < acqcount; i++) bno_trace_dump(bno_acq_dev(acq, i), 2);
+   bno_acq_close(acq);
+}
+
+/* ----------------------------------------------------------- *
+ *  trace_exit() - print the "-T" trace of the single sensor    *
+ * ----------------------------------------------------------- */
+static void trace_exit() {
+   if(tracebno != NULL) bno_trace_dump(tracebno, 2);
+}
+
+/* ----------------------------------------------------------- *
+ *  acquire() - "-s" read all listed sensors with one thread    *
+ *  per bus, print each sample in the -F format, or with -P     *
+ *  publish it to shared memory, with -C write it to a capture. *
+ * ----------------------------------------------------------- */
+int acquire() {
+   /* ----------------------------------------------------------- *
+    * without -f, replays of capture files run as fast as they   *
+    * can be read, live sensors at the fusion data rate          *
+    * ----------------------------------------------------------- */
+   int i;
+   double hz = rate;
+   for(i = 0; hz == 0 && i < acqcount; i++)
+      if(strncmp(acqsens[i], "replay:", 7) != 0) hz = BNO_FUSION_HZ;
+
+   struct bnoacq *acq = bno_acq_new(hz, verbose);
+   if(acq == NULL) return(-1);
+
+   /* ----------------------------------------------------------- *
+    * every exit from here on goes through "done", which closes  *
+    * what was opened: the shm segment is unlinked and a capture *
+    * file gets its header even after an error.                  *
+    * ----------------------------------------------------------- */
+   struct bnoshm *shm = NULL;
+   struct bnocap *cap = NULL;
+   struct bnoout *out = NULL;
+   int res = -1;
+
+   for(i = 0; i < acqcount; i++) {
+      char *at = strrchr(acqsens[i], '@');
+      *at = '\0';
+      if(bno_acq_add(acq, acqsens[i], at + 1) < 0
+         || (tracelen > 0 && bno_trace_start(bno_acq_dev(acq, i), tracelen) != 0)) goto done;
+   }
+   if(strlen(shmpub) > 0 && (shm = bno_shm_create(shmpub, verbose)) == NULL) goto done;
+   if(strlen(capfile) > 0) {
+      if((cap = bno_cap_create(capfile, hz, capenc, verbose)) == NULL) goto done;
+      for(i = 0; i < acqcount; i++)
+         if(bno_cap_sensor(cap, bno_acq_dev(acq, i), acqsens[i]) != 0) goto done;
+   }
+   if(shm == NULL && cap == NULL) {
+      out = bno_out_open(STDOUT_FILENO, outfmt, BNO_F_ALL | BNO_OUT_HEAD);
+      if(out == NULL) goto done;
+   }
+   if(bno_acq_start(acq) != 0) goto done;
+
+   /* ----------------------------------------------------------- *
+    * give up if no sample came for two sweep periods, min. 1s   *
+    * ----------------------------------------------------------- */
+   long idle_ms = 1000;
+   if(hz > 0 && 2000 / hz > idle_ms) idle_ms = (long)(2000 / hz) + 1;
+   long n = 0;
+   long xfer_max[BNO_ACQ_MAX] = {0};
+   int idle = 0;
+   struct bnosample smp;
+   while(samples == 0 || n < samples) {
+      if(bno_acq_read(acq, &smp, 100) != 0) {
+         if(bno_acq_active(acq) == 0) {          // replay ended, drain the ring
+            if(bno_acq_read(acq, &smp, 0) != 0) break;
+         }
+         else if(++idle * 100 < idle_ms) {
+            if(out != NULL) bno_out_flush(out); // no new rows, do not hold back
+            continue;
+         }
+         else {
+            printf("Error: no sensor data for %.1fs.\n", idle_ms / 1000.0);
+            goto done;
+         }
+      }
+      idle = 0;
+      if(smp.snap.ts.xfer_ns > xfer_max[smp.sensor]) xfer_max[smp.sensor] = smp.snap.ts.xfer_ns;
+      if(shm != NULL) bno_shm_publish(shm, &smp);
+      if(cap != NULL && bno_cap_write(cap, &smp, bno_acq_dropped(acq)) != 0) goto done;
+      if(out != NULL && bno_out_sample(out, &smp) != 0) goto done;
+      n++;
+   }
+   res = bno_out_close(out);                   // rows out before the debug lines
+   out = NULL;
+   if(res != 0) goto done;
+
+   if(verbose == 1) printf("Debug: %ld samples, %lu dropped, %lu overruns\n", n,
+                           bno_acq_dropped(acq), bno_acq_overruns(acq));
+   if(verbose == 1) for(i = 0; i < acqcount; i++) {
+      printf("Debug: sensor %d slowest bus transaction %ld us\n", i, xfer_max[i] / 1000);
+      fflush(stdout);
+      bno_errs_dump(bno_acq_dev(acq, i), 1);
+   }
+
+done:
+   acq_close(acq);
+   bno_shm_close(shm);
+   if(bno_cap_close(cap) != 0) res = -1;
+   if(bno_out_close(out) != 0) res = -1;
+   return(res);
+}
+
+/* ----------------------------------------------------------- *
+ *  capture_print() - "-X" print the samples of a capture file  *
+ *  like -s does, with -v also the header and index records.    *
+ * ----------------------------------------------------------- */
+int capture_print() {
+   struct bnocapfile *cf = bno_cap_open(capread);
+   if(cf == NULL) return(-1);
+
+   const struct bnocaphdr *h = bno_cap_header(cf);
+   int i;
+   if(verbose == 1) {
+      printf("Debug: capture v%d%s, %u sensors, %.3f Hz, %ld slots\n", h->version,
+             h->encoding == BNO_CAP_PACKED ? " packed" : "",
+             h->nsensors, h->rate_mhz / 1000.0, bno_cap_slots(cf));
+      for(i = 0; i < (int) h->nsensors; i++)
+         printf("Debug: sensor %d [%s] [0x%02X] mode 0x%02X units 0x%02X remap 0x%02X/0x%02X cal 0x%02X\n",
+                i, h->sens[i].bus, h->sens[i].addr, h->sens[i].opr_mode, h->sens[i].unit_sel,
+                h->sens[i].axr_conf, h->sens[i].axr_sign, h->sens[i].calib_st);
+   }
+
+   struct bnoout *out = bno_out_open(STDOUT_FILENO, outfmt, BNO_F_ALL | BNO_OUT_HEAD);
+   if(out == NULL) {
+      bno_cap_unmap(cf);
+      return(-1);
+   }
+   long n, count = 0;
+   struct bnosample smp;
+   for(n = 0; n < bno_cap_slots(cf) && (samples == 0 || count < samples); n++) {
+      if(bno_cap_sample(cf, n, &smp) == 0) {
+         if(bno_out_sample(out, &smp) != 0) break;
+         count++;
+      }
+      else if(verbose == 1 && bno_cap_rec(cf, n) != NULL) {
+         struct bnocapidx idx;
+         memcpy(&idx, bno_cap_rec(cf, n)->reg, sizeof(idx));
+         bno_out_flush(out);
+         printf("Debug: index slot %ld, %llu records, %llu dropped\n", n,
+                (unsigned long long) idx.datarecs, (unsigned long long) idx.dropped);
+      }
+   }
+   bno_cap_unmap(cf);
+   return(bno_out_close(out));
+}
+
+/* ----------------------------------------------------------- *
+ *  shm_print() - "-R" print the newest sample of each sensor   *
+ *  a -P publisher has delivered so far, no bus access needed.  *
+ * ----------------------------------------------------------- */
+int shm_print() {
+   struct bnoshm *shm = bno_shm_open(shmread);
+   if(shm == NULL) return(-1);
+
+   struct bnoout *out = bno_out_open(STDOUT_FILENO, outfmt, BNO_F_ALL | BNO_OUT_HEAD);
+   if(out == NULL) {
+      bno_shm_close(shm);
+      return(-1);
+   }
+   struct bnosample smp;
+   int i, found = 0;
+   for(i = 0; i < BNO_ACQ_MAX; i++) {
+      long count = bno_shm_read(shm, i, &smp);
+      if(count < 0 && errno == EAGAIN)
+         printf("Error: sensor %d slot in [%s] stays mid-write, publisher died?\n", i, shmread);
+      if(count <= 0) continue;
+      if(verbose == 1) printf("Debug: sensor %d, sample %ld\n", i, count);
+      bno_out_sample(out, &smp);
+      found++;
+   }
+   bno_shm_close(shm);
+   if(bno_out_close(out) != 0) return(-1);
+   if(found == 0) {
+      printf("Error: no samples published in [%s] yet.\n", shmread);
+      return(-1);
+   }
+   return(0);
+}
+
+/* ----------------------------------------------------------- *
+ *  subscribe() - "-D" get the samples from a bno055d daemon,   *
+ *  all fields of all its sensors, at the -f rate per sensor.   *
+ * ----------------------------------------------------------- */
+int subscribe() {
+   /* ----------------------------------------------------------- *
+    * the subscription carries whole Hz and 0 means every sample *
+    * ----------------------------------------------------------- */
+   if(rate > 0 && rate < 1) {
+      printf("Error: -f %.2f Hz, a bno055d subscription needs at least 1 Hz.\n", rate);
+      return(-1);
+   }
+   int fd = bno_sub_connect(daemonsock);
+   if(fd < 0) return(-1);
+   if(bno_sub_request(fd, BNO_F_ALL, 0, (uint16_t)(rate + 0.5)) != 0) {
+      close(fd);
+      return(-1);
+   }
+
+   struct bnoout *out = bno_out_open(STDOUT_FILENO, outfmt, BNO_F_ALL | BNO_OUT_HEAD);
+   if(out == NULL) {
+      close(fd);
+      return(-1);
+   }
+   long n = 0;
+   struct bnoframe hdr;
+   struct bnosample smp;
+   while(samples == 0 || n < samples) {
+      if(bno_sub_read(fd, &hdr, &smp) != 0 || bno_out_sample(out, &smp) != 0) {
+         bno_out_close(out);
+         printf("Error: connection to bno055d lost.\n");
+         close(fd);
+         return(-1);
+      }
+      n++;
+   }
+   int res = bno_out_close(out);
+   if(verbose == 1) printf("Debug: %ld frames, %u dropped by the daemon\n", n, hdr.dropped);
+   close(fd);
+   return(res);
+}
 
 int main(int argc, char *argv[]) {
    int res = -1;       // res = function retcode: 0=OK, -1 = Error
@@ -329,16 +780,54 @@ int main(int argc, char *argv[]) {
    time_t tsnow = time(NULL);
    if(verbose == 1) printf("Debug: ts=[%lld] date=%s", (long long) tsnow, ctime(&tsnow));
 
+   /* ----------------------------------------------------------- *
+    * "-s" multi-sensor acquisition, runs until -n samples are in *
+    * ----------------------------------------------------------- */
+   if(acqcount > 0) {
+      res = acquire();
+      exit(res);
+   }
+
+   /* ----------------------------------------------------------- *
+    * "-R" print the published samples from shared memory         *
+    * ----------------------------------------------------------- */
+   if(strlen(shmread) > 0) {
+      res = shm_print();
+      exit(res);
+   }
+
+   /* ----------------------------------------------------------- *
+    * "-D" print the samples served by a bno055d daemon           *
+    * ----------------------------------------------------------- */
+   if(strlen(daemonsock) > 0) {
+      res = subscribe();
+      exit(res);
+   }
+
+   /* ----------------------------------------------------------- *
+    * "-X" print the samples of a binary capture file             *
+    * ----------------------------------------------------------- */
+   if(strlen(capread) > 0) {
+      res = capture_print();
+      exit(res);
+   }
+
    /* ----------------------------------------------------------- *
     * "-a" open the I2C bus and connect to the sensor i2c address *
     * ----------------------------------------------------------- */
-   get_i2cbus(i2c_bus, senaddr);
+   bno055_t *bno = bno_open(i2c_bus, senaddr, verbose);
+   if(bno == NULL) exit(-1);
+   if(tracelen > 0) {
+      if(bno_trace_start(bno, tracelen) != 0) exit(-1);
+      tracebno = bno;
+      atexit(trace_exit);
+   }
 
    /* ----------------------------------------------------------- *
     *  "-d" dump the register map content and exit the program    *
     * ----------------------------------------------------------- */
     if(argflag == 1) {
-      res = bno_dump();
+      res = bno_dump(bno);
       if(res != 0) {
          printf("Error: could not dump the register maps.\n");
          exit(-1);
@@ -350,7 +839,7 @@ int main(int argc, char *argv[]) {
     *  "-r" reset the sensor and exit the program                 *
     * ----------------------------------------------------------- */
     if(argflag == 2) {
-      res = bno_reset();
+      res = bno_reset(bno);
       if(res != 0) {
          printf("Error: could not reset the sensor.\n");
          exit(-1);
@@ -381,7 +870,7 @@ int main(int argc, char *argv[]) {
          exit(-1);
       }
       
-      res = set_mode(newmode);
+      res = set_mode(bno, newmode);
       if(res != 0) {
          printf("Error: could not set sensor mode %s [0x%02X].\n", opr_mode, newmode);
          exit(-1);
@@ -402,12 +891,12 @@ int main(int argc, char *argv[]) {
          exit(-1);
       }
 
-      if(newmode == get_power()) {
+      if(newmode == get_power(bno)) {
          if(verbose == 1) printf("Debug: Sensor already in mode %s [0x%02X].\n", pwr_mode, newmode);
          exit(0);
       }
 
-      res = set_power(newmode);
+      res = set_power(bno, newmode);
       if(res != 0) {
          printf("Error: could not set power mode %s [0x%02X].\n", pwr_mode, newmode);
          exit(-1);
@@ -419,7 +908,10 @@ int main(int argc, char *argv[]) {
     *  "-l" loads the sensor calibration data from file.          *
     * To update calibration data, sensor must be in CONFIG mode.  *
     * ----------------------------------------------------------- */
-    if(argflag == 3) load_cal(calfile);
+    if(argflag == 3 && load_cal(bno, calfile) != 0) {
+      printf("Error: could not load calibration data from %s.\n", calfile);
+      exit(-1);
+   }
 
    /* ----------------------------------------------------------- *
     * -t "cal"  print the sensor calibration data                 *
@@ -429,7 +921,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Read the sensors calibration state                      *
        * -------------------------------------------------------- */
-      res = get_calstatus(&bnoc);
+      res = get_calstatus(bno, &bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration state.\n");
          exit(-1);
@@ -437,7 +929,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Read the sensors calibration offset                     *
        * -------------------------------------------------------- */
-      res = get_caloffset(&bnoc);
+      res = get_caloffset(bno, &bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration data.\n");
          exit(-1);
@@ -469,7 +961,7 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Check the sensors calibration state                     *
        * -------------------------------------------------------- */
-      res = get_calstatus(&bnoc);
+      res = get_calstatus(bno, &bnoc);
       if(res != 0) {
          printf("Error: Cannot read calibration state.\n");
          exit(-1);
@@ -477,7 +969,9 @@ int main(int argc, char *argv[]) {
       /* -------------------------------------------------------- *
        *  Only save data if the sensor is fully calibrated (3)    *
        * -------------------------------------------------------- */
-      if(bnoc.scal_st == 3) save_cal(calfile);
+      if(bnoc.scal_st == 3) {
+         if(save_cal(bno, calfile) != 0) exit(-1);
+      }
       else printf("Error: Sensor not fully calibrated, abort writing to file %s.\n", calfile);
    }
 
@@ -487,7 +981,7 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "inf") == 0) {
       struct bnoinf bnoi;
-      res = get_inf(&bnoi);
+      res = get_inf(bno, &bnoi);
       if(res != 0) {
          printf("Error: Cannot read sensor version data.\n");
          exit(-1);
@@ -508,7 +1002,7 @@ int main(int argc, char *argv[]) {
       printf("Axis Configuration = "); print_remap_conf(bnoi.axr_conf);
       printf("   Axis Remap Sign = "); print_remap_sign(bnoi.axr_sign);
       printf("System Status Code = "); print_sstat(bnoi.sys_stat);
-      printf("System Clocksource = "); print_clksrc();
+      printf("System Clocksource = "); print_clksrc(bno);
 
       printf("Accelerometer Test = ");
       if((bnoi.selftest >> 0) & 0x01) printf("OK\n");
@@ -574,10 +1068,16 @@ int main(int argc, char *argv[]) {
 
       printf("\n----------------------------------------------\n");
       struct bnoaconf bnoac;
-      if(get_acc_conf(&bnoac) == 0) print_acc_conf(&bnoac);
+      struct bnomconf bnomc;
+      struct bnogconf bnogc;
+      if(get_conf(bno, &bnoac, &bnomc, &bnogc) == 0) {
+         print_acc_conf(&bnoac);
+         print_mag_conf(&bnomc);
+         print_gyr_conf(&bnogc);
+      }
 
       printf("\n----------------------------------------------\n");
-      print_calstat();
+      print_calstat(bno);
       exit(0);
    }
 
@@ -585,111 +1085,63 @@ int main(int argc, char *argv[]) {
     *  "-t acc " reads accelerometer data from the sensor.        *
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "acc") == 0) {
-      struct bnoacc bnod;
-      res = get_acc(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_acc(bno, &bnod.acc);
       if(res != 0) {
          printf("Error: Cannot read accelerometer data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.acc.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * ACC -45.00 264.00 939.00 (ACC X Y Z)                        *
        * ----------------------------------------------------------- */
-      printf("ACC %3.2f %3.2f %3.2f\n", bnod.adata_x, bnod.adata_y, bnod.adata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing accelerometer data       *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Accelerometer Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.adata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_ACC) != 0) exit(-1);
    } /* End reading Accelerometer */
 
    /* ----------------------------------------------------------- *
     *  "-t gyr" reads gyroscope data from the sensor.             *
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "gyr") == 0) {
-      struct bnogyr bnod;
-      res = get_gyr(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_gyr(bno, &bnod.gyr);
       if(res != 0) {
          printf("Error: Cannot read gyroscope data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.gyr.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * GYR 0.00 0.06 -0.12 (GYR X Y Z)                             *
        * ----------------------------------------------------------- */
-      printf("GYR %3.2f %3.2f %3.2f\n", bnod.gdata_x, bnod.gdata_y, bnod.gdata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing gyroscope data           *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gyroscope Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gdata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_GYR) != 0) exit(-1);
    } /* End reading Gyroscope */
 
    /* ----------------------------------------------------------- *
     *  "-t mag" reads magnetometer data from the sensor.          *
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "mag") == 0) {
-      struct bnomag bnod;
-      res = get_mag(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_mag(bno, &bnod.mag);
       if(res != 0) {
          printf("Error: Cannot read magnetometer data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.mag.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *              
        * MAG -220.00 50.62 -345.62 (MAG X Y Z in Micro Tesla)        *
        * ----------------------------------------------------------- */
-      printf("MAG %3.2f %3.2f %3.2f\n", bnod.mdata_x, bnod.mdata_y, bnod.mdata_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Magnetometer data        *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Magnetometer X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Magnetometer Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Magentometer Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.mdata_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_MAG) != 0) exit(-1);
    } /* End reading Magnetometer data */
 
    /* ----------------------------------------------------------- *
@@ -698,90 +1150,105 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "eul") == 0) {
 
-      int mode = get_mode();
+      int mode = get_mode(bno);
       if(mode < 8) {
          printf("Error getting Euler data, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnoeul bnod;
-      res = get_eul(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_eul(bno, &bnod.eul);
       if(res != 0) {
          printf("Error: Cannot read Euler orientation data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.eul.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * EUL 66.06 -3.00 -15.56 (EUL H R P in Degrees)               *
        * ----------------------------------------------------------- */
-      printf("EUL %3.4f %3.4f %3.4f\n", bnod.eul_head, bnod.eul_roll, bnod.eul_pitc);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Euler Orientation data   *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Heading:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_head);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Roll:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_roll);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Pitch:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_pitc);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_EUL) != 0) exit(-1);
    } /* End reading Euler Orientation */
 
   /* ----------------------------------------------------------- *
     *  "-t continuous"                                            *
     * This requires the sensor to be in fusion mode (mode > 7).   *
+    * Samples at the -f rate on a fixed time grid, late samples   *
+    * skip the missed periods and get reported as overruns. With  *
+    * "-i", the loop sleeps until a motion interrupt arrives and  *
+    * gets data plus INTR_STAT in one snapshot read.              *
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "continuous") == 0) {
 
-      int mode = get_mode();
+      int mode = get_mode(bno);
       if(mode < 8) {
          printf("Error getting Euler data, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnoeul bnod;
+      if(strlen(irqline) > 0) {
+         if(set_intr(bno, BNO055_INT_ACC_AM | BNO055_INT_GYR_AM) != 0
+            || bno_irq_open(bno, irqline) != 0 || bno_irq_clear(bno) != 0) {
+            printf("Error: Cannot set up the sensor interrupt on [%s].\n", irqline);
+            exit(-1);
+         }
+      }
+
+      struct bnotick tick;
+      if(rate > BNO_FUSION_HZ) {
+         printf("Error: -f %.2f Hz exceeds the %d Hz fusion data rate.\n", rate, BNO_FUSION_HZ);
+         exit(-1);
+      }
+      if(bno_tick_init(&tick, rate > 0 ? rate : 1.0) != 0) exit(-1);
+
+      struct bnoout *out = bno_out_open(STDOUT_FILENO, outfmt, BNO_F_EUL);
+      if(out == NULL) exit(-1);
+      struct bnohtml *html = NULL;
+      if(outflag == 1 && (html = bno_html_open(htmfile, BNO_F_EUL, deadband, htmlhz, verbose)) == NULL) exit(-1);
+      struct bnosample smp;
+      memset(&smp, 0, sizeof(smp));
+      long n = 0;
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * EUL 66.06 -3.00 -15.56 (EUL H R P in Degrees)               *
        * ----------------------------------------------------------- */
-      while(1){
-        res = get_eul(&bnod);
+      while(samples == 0 || n < samples){
+        if(strlen(irqline) > 0) {
+           res = bno_irq_wait(bno, 1000);
+           if(res == 0) continue;          // no motion, no bus traffic
+           if(res < 0) {
+              printf("Error: Cannot wait for the sensor interrupt.\n");
+              exit(-1);
+           }
+           res = get_snapshot(bno, &smp.snap);
+           if(bno_irq_clear(bno) != 0) res = -1;
+           if(verbose == 1 && res == 0) printf("Debug: INTR_STAT [0x%02X]\n", smp.snap.intr_st & 0xFF);
+        }
+        else {
+           int missed = bno_tick_wait(&tick);
+           if(missed < 0) {
+              printf("Error: sample timer failure.\n");
+              exit(-1);
+           }
+           if(missed > 0) fprintf(stderr, "Warning: sampler overrun, %d sample(s) skipped, %lu total\n",
+                                  missed, tick.overruns);
+           res = get_eul(bno, &smp.snap.eul);
+           smp.snap.ts = smp.snap.eul.ts;
+        }
         if(res != 0) {
            printf("Error: Cannot read Euler orientation data.\n");
            continue;
         }
-        printf("EUL %3.4f %3.4f %3.4f\n", bnod.eul_head, bnod.eul_roll, bnod.eul_pitc);
-        sleep(1);
-        if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Euler Orientation data   *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Heading:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_head);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Roll:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_roll);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Euler Pitch:<span class=\"sensorvalue\">%f</span></td>\n", bnod.eul_pitc);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-        }
+        if(bno_out_sample(out, &smp) != 0) exit(-1);
+        n++;
+        if(html != NULL && bno_html_update(html, &smp.snap) < 0) exit(-1);
       }
-      
+      bno_out_close(out);
+      if(bno_html_close(html) != 0) exit(-1);
+      exit(0);
    } /* End reading continuous data */
 
    /* ----------------------------------------------------------- *
@@ -790,45 +1257,27 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "qua") == 0) {
 
-      int mode = get_mode();
+      int mode = get_mode(bno);
       if(mode < 8) {
          printf("Error getting Quaternation, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnoqua bnod;
-      res = get_qua(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_qua(bno, &bnod.qua);
       if(res != 0) {
          printf("Error: Cannot read Quaternation data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.qua.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * QUA 0.83 0.13 -0.05 -0.54 (QUA W X Y Z)                     *
        * ----------------------------------------------------------- */
-      printf("QUA %3.2f %3.2f %3.2f %3.2f\n", bnod.quater_w, bnod.quater_x, bnod.quater_y, bnod.quater_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing Quaternation data        *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation W:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_w);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Quaternation Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.quater_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_QUA) != 0) exit(-1);
    } /* End reading Quaternation data */
 
    /* ----------------------------------------------------------- *
@@ -837,43 +1286,27 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "gra") == 0) {
 
-      int mode = get_mode();
+      int mode = get_mode(bno);
       if(mode < 8) {
          printf("Error getting Gravity Vector, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnogra bnod;
-      res = get_gra(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_gra(bno, &bnod.gra);
       if(res != 0) {
          printf("Error: Cannot read gravity vector data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.gra.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * GRA -3.19 16.38 58.94 (GRA X Y Z)                           *
        * ----------------------------------------------------------- */
-      printf("GRA %3.2f %3.2f %3.2f\n", bnod.gravityx, bnod.gravityy, bnod.gravityz);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing gravity vector data      *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityx);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityy);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Gravity Vector Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.gravityz);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_GRA) != 0) exit(-1);
    } /* End reading Gravity  Vector */
 
    /* ----------------------------------------------------------- *
@@ -882,44 +1315,45 @@ int main(int argc, char *argv[]) {
     * ----------------------------------------------------------- */
    if(strcmp(datatype, "lin") == 0) {
 
-      int mode = get_mode();
+      int mode = get_mode(bno);
       if(mode < 8) {
          printf("Error getting Linear Acceleration, sensor mode %d is not a fusion mode.\n", mode);
          exit(-1);
       }
 
-      struct bnolin bnod;
-      res = get_lin(&bnod);
+      struct bnosnap bnod;
+      memset(&bnod, 0, sizeof(bnod));
+      res = get_lin(bno, &bnod.lin);
       if(res != 0) {
          printf("Error: Cannot read linear acceleration data.\n");
          exit(-1);
       }
 
+      bnod.ts = bnod.lin.ts;
+
       /* ----------------------------------------------------------- *
        * print the formatted output string to stdout (Example below) *
        * LIN 0.44 0.19 -0.38 (LIN X Y Z)                             *
        * ----------------------------------------------------------- */
-      printf("LIN %3.2f %3.2f %3.2f\n", bnod.linacc_x, bnod.linacc_y, bnod.linacc_z);
-
-      if(outflag == 1) {
-         /* -------------------------------------------------------- *
-          *  Open the html file for writing linear acceleration data *
-          * -------------------------------------------------------- */
-         FILE *html;
-         if(! (html=fopen(htmfile, "w"))) {
-            printf("Error open %s for writing.\n", htmfile);
-            exit(-1);
-         }
-         fprintf(html, "<table><tr>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration X:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_x);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration Y:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_y);
-         fprintf(html, "<td class=\"sensorspace\"></td>\n");
-         fprintf(html, "<td class=\"sensordata\">Linear Acceleration Z:<span class=\"sensorvalue\">%3.2f</span></td>\n", bnod.linacc_z);
-         fprintf(html, "</tr></table>\n");
-         fclose(html);
-      }
+      if(print_data(&bnod, BNO_F_LIN) != 0) exit(-1);
    } /* End reading Linear Acceleration */
 
+   /* ----------------------------------------------------------- *
+    *  "-t snp" reads all data registers with one burst transfer. *
+    * ----------------------------------------------------------- */
+   if(strcmp(datatype, "snp") == 0) {
+      struct bnosnap bnod;
+      res = get_snapshot(bno, &bnod);
+      if(res != 0) {
+         printf("Error: Cannot read sensor data snapshot.\n");
+         exit(-1);
+      }
+
+      /* ----------------------------------------------------------- *
+       * print one line per data type, same format as the -t output  *
+       * ----------------------------------------------------------- */
+      if(print_data(&bnod, BNO_F_ALL) != 0) exit(-1);
+   } /* End reading data snapshot */
+
    exit(0);
 }
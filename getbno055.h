@@ -4,6 +4,8 @@
  *                                                              *
  * author:      05/04/2018 Frank4DD                             *
  * ------------------------------------------------------------ */
+#include <stdint.h>
+#include <time.h>
 
 #define I2CBUS               "/dev/i2c-1"
 #define BNO055_ID            0xA0
@@ -164,12 +166,191 @@
 #define BNO055_GYR_CONFIG1_ADDR           0x0B
 #define BNO055_ACC_SLEEP_CONFIG_ADDR      0x0C
 #define BNO055_GYR_SLEEP_CONFIG_ADDR      0x0D
+#define BNO055_INT_MSK_ADDR               0x0F
+#define BNO055_INT_EN_ADDR                0x10
 
 /* ------------------------------------------------------------ *
- * global variables                                             *
+ * Interrupt bits, same layout in INT_MSK, INT_EN and INTR_STAT *
  * ------------------------------------------------------------ */
-int i2cfd;       // I2C file descriptor
-int verbose;     // debug flag, 0 = normal, 1 = debug mode
+#define BNO055_INT_GYR_AM                 0x04
+#define BNO055_INT_GYR_HIGH_RATE          0x08
+#define BNO055_INT_ACC_HIGH_G             0x20
+#define BNO055_INT_ACC_AM                 0x40
+#define BNO055_INT_ACC_NM                 0x80
+
+/* ------------------------------------------------------------ *
+ * Register block read request for batched I2C_RDWR transfers.  *
+ * The kernel allows 42 messages per ioctl, each block needs 2. *
+ * ------------------------------------------------------------ */
+#define BNO_XFER_MAX         21
+struct bnoxfer{
+   unsigned char reg;  // first register of the block
+   int len;            // number of bytes to read
+   void *buf;          // destination buffer, at least len bytes
+};
+
+/* ------------------------------------------------------------ *
+ * Sample time of a register read. tstamp is CLOCK_MONOTONIC_RAW *
+ * at the midpoint of the bus transaction, the best estimate of  *
+ * when the sensor latched the data, unaffected by NTP slewing.  *
+ * xfer_ns is the transaction duration, spikes are bus stalls.   *
+ * ------------------------------------------------------------ */
+struct bnotime{
+   struct timespec tstamp;   // CLOCK_MONOTONIC_RAW, transaction midpoint
+   long xfer_ns;             // transaction duration in nanoseconds
+};
+
+/* ------------------------------------------------------------ *
+ * Bus transport vtable. The register access functions go      *
+ * through it, so the same code drives the Linux i2c-dev bus,  *
+ * the UART protocol in uart_bno055.c or the simulated sensor  *
+ * in sim_bno055.c. read_multi() is optional, without it the   *
+ * register blocks are read one by one. irq_line() is optional *
+ * too, it returns a poll()-able fd standing in for the INT pin*
+ * when the backend models one (the simulator does). stamp() is*
+ * optional, a backend serving recorded data (the replay) sets *
+ * the recorded sample time of the last read with it.          *
+ * ------------------------------------------------------------ */
+struct bnotransport{
+   const char *name;                                                // backend name
+   int  (*open)(struct bnotransport*, const char*, int);            // open bus, addr
+   int  (*read_regs)(struct bnotransport*, unsigned char, void*, int);
+   int  (*read_multi)(struct bnotransport*, struct bnoxfer*, int);  // may be NULL
+   int  (*write_regs)(struct bnotransport*, unsigned char, const void*, int);
+   void (*close)(struct bnotransport*);
+   int  (*irq_line)(struct bnotransport*);                          // may be NULL
+   int  (*stamp)(struct bnotransport*, struct bnotime*);            // may be NULL
+   void *priv;                                                      // backend state
+   int  verbose;                                                    // debug flag
+};
+
+extern const struct bnotransport bno_i2cdev_transport; // Linux /dev/i2c-N
+extern const struct bnotransport bno_sim_transport;    // simulated BNO055
+extern const struct bnotransport bno_uart_transport;   // UART mode, PS1 high
+extern const struct bnotransport bno_replay_transport; // capture file playback
+
+struct bnopty;               // pty UART stand-in (pty_bno055.c, tools only), opaque
+
+/* ------------------------------------------------------------ *
+ * Register shadow: host copy of the slow-changing config regs, *
+ * so sample reads need no UNIT_SEL or OPR_MODE round trips.    *
+ * Page 0: 0x3B UNIT_SEL .. 0x42 AXIS_MAP_SIGN (w/o SYS_TRIGGER)*
+ * Page 1: 0x08 ACC_CONFIG .. 0x1F (configs, int mask/settings) *
+ * ------------------------------------------------------------ */
+#define SHADOW_P0_START      BNO055_UNIT_SEL_ADDR
+#define SHADOW_P0_END        BNO055_AXIS_MAP_SIGN_ADDR
+#define SHADOW_P1_START      BNO055_ACC_CONFIG_ADDR
+#define SHADOW_P1_END        0x1F
+
+struct bnoshadow{
+   int page;          // current register page, -1 = unknown
+   int valid[2];      // page block was read from the sensor
+   unsigned char p0[SHADOW_P0_END - SHADOW_P0_START + 1];
+   unsigned char p1[SHADOW_P1_END - SHADOW_P1_START + 1];
+};
+
+/* ------------------------------------------------------------ *
+ * Library diagnostics (log_bno055.c). Debug lines cost a not-  *
+ * taken branch, and nothing if built with -DBNO_NO_DEBUG (make *
+ * LOGFLAGS=-DBNO_NO_DEBUG). Errors and debug go to bno_log(),  *
+ * which writes errors to stderr and debug to stdout unless an  *
+ * application installs its own handler with bno_log_set().     *
+ * ------------------------------------------------------------ */
+#define BNO_LOG_ERR          0
+#define BNO_LOG_DEBUG        1
+
+#ifdef BNO_NO_DEBUG
+#define BNO_DEBUG(flag, ...) do { if(0 && (flag)) bno_log(BNO_LOG_DEBUG, __VA_ARGS__); } while(0)
+#else
+#define BNO_DEBUG(flag, ...) do { if(__builtin_expect((flag) == 1, 0)) bno_log(BNO_LOG_DEBUG, __VA_ARGS__); } while(0)
+#endif
+#define BNO_ERROR(...)       bno_log(BNO_LOG_ERR, __VA_ARGS__)
+
+typedef void (*bno_logfn)(int, const char*); // level, one formatted message
+
+/* ------------------------------------------------------------ *
+ * Transaction trace ring: the last 2^n register transactions   *
+ * of a handle, recorded in binary while tracing is on and only *
+ * formatted by bno_trace_dump(). Entries are seqlocked, a dump *
+ * from another thread skips the ones being overwritten.        *
+ * ------------------------------------------------------------ */
+#define BNO_TR_READ          0
+#define BNO_TR_WRITE         1
+#define BNO_TR_MULTI         2     // batched read, reg/len of the first block
+
+struct bnotrent{
+   uint32_t seq;             // transaction number, 0 = being written
+   uint8_t  op;              // BNO_TR_ operation
+   uint8_t  reg;             // first register
+   uint8_t  page;            // register page, 0xFF = unknown
+   uint8_t  count;           // register blocks, 1 except for BNO_TR_MULTI
+   uint16_t len;             // bytes transferred
+   int16_t  result;          // 0 = OK, or -errno of the failure
+   uint32_t dur_ns;          // transaction duration
+   int64_t  tstamp_ns;       // start time, CLOCK_MONOTONIC_RAW
+};
+
+struct bnotrace{
+   uint32_t mask;            // entries - 1, entries is a power of 2
+   uint32_t seq;             // transactions recorded
+   struct bnotrent ent[];
+};
+
+/* ------------------------------------------------------------ *
+ * Bus error handling. Library functions return -1 on errors    *
+ * and leave errno as the failing system or transport call set  *
+ * it. bno_errclass() sorts an errno into a BNO_E_ class. Bus   *
+ * transactions failing with a transient class are repeated up  *
+ * to bno->retry.max times, with a backoff doubling from        *
+ * delay_us up to delay_max_us. bno->errs counts the failures.  *
+ * ------------------------------------------------------------ */
+#define BNO_E_OK             0     // no error
+#define BNO_E_NACK           1     // no acknowledge, sensor busy or booting
+#define BNO_E_TIMEOUT        2     // bus or UART response timeout
+#define BNO_E_BUS            3     // bus, arbitration or protocol error
+#define BNO_E_NODEV          4     // no such bus or device, not transient
+#define BNO_E_NODATA         5     // recorded data ended, not transient
+#define BNO_E_OTHER          6     // invalid request and the rest
+#define BNO_E_CLASSES        7
+
+#define BNO_RETRY_MAX        3     // default retries after the first attempt
+#define BNO_RETRY_US         100   // default first backoff
+#define BNO_RETRY_MAX_US     2000  // default backoff cap
+
+struct bnoretry{
+   int  max;                 // retries per transaction, 0 = none
+   long delay_us;            // first backoff, doubled per retry
+   long delay_max_us;        // backoff cap
+};
+
+struct bnoerrs{
+   unsigned long count[BNO_E_CLASSES]; // failed attempts per class
+   unsigned long retries;    // attempts repeated
+   unsigned long recovered;  // transactions that succeeded on a retry
+   unsigned long failed;     // transactions given up
+   int last;                 // BNO_E_ class of the last failure
+   int last_errno;           // errno of the last failure
+};
+
+/* ------------------------------------------------------------ *
+ * BNO055 device handle, created by bno_open(). It owns the bus *
+ * connection and all per-sensor state, the library keeps no    *
+ * globals. A handle must not be used by two threads at once.   *
+ * ------------------------------------------------------------ */
+typedef struct bno055{
+   struct bnotransport bus;   // bus backend and its private state
+   int addr;                  // sensor I2C address, 0x28 or 0x29
+   int verbose;               // debug flag, 0 = normal, 1 = debug mode
+   struct bnoshadow shadow;   // register shadow and page state
+   int irqfd;                 // INT line fd from bno_irq_open(), -1 = none
+   int irqgpio;               // 1 = irqfd is a gpiochip line request
+   unsigned char irqtrig;     // SYS_TRIGGER CLK_SEL bit, kept on RST_INT
+   struct bnotime xfer;       // timing of the last register read
+   long xfer_max_ns;          // slowest register read since bno_open()
+   struct bnotrace *trace;    // transaction ring, NULL = not tracing
+   struct bnoretry retry;     // transient bus error retry policy
+   struct bnoerrs errs;       // bus error counters since bno_open()
+} bno055_t;
 
 /* ------------------------------------------------------------ *
  * BNO055 versions, status data and other infos struct          *
@@ -226,39 +407,374 @@ struct bnoacc{
    double adata_x;   // accelerometer data, X-axis
    double adata_y;   // accelerometer data, Y-axis
    double adata_z;   // accelerometer data, Z-axis
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnomag{
    double mdata_x;   // magnetometer data, X-axis
    double mdata_y;   // magnetometer data, Y-axis
    double mdata_z;   // magnetometer data, Z-axis
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnogyr{
    double gdata_x;   // gyroscope data, X-axis
    double gdata_y;   // gyroscope data, Y-axis
    double gdata_z;   // gyroscope data, Z-axis
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnoeul{
    double eul_head;  // Euler heading data
    double eul_roll;  // Euler roll data
    double eul_pitc;  // Euler picth data
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnoqua{
    double quater_w;  // Quaternation data W
    double quater_x;  // Quaternation data X
    double quater_y;  // Quaternation data Y
    double quater_z;  // Quaternation data Z
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnogra{
    double gravityx;  // Gravity Vector X
    double gravityy;  // Gravity Vector Y
    double gravityz;  // Gravity Vector Z
+   struct bnotime ts; // sample time and bus transaction duration
 };
 struct bnolin{
    double linacc_x;  // Linear Acceleration X
    double linacc_y;  // Linear Acceleration Y
    double linacc_z;  // Linear Acceleration Z
+   struct bnotime ts; // sample time and bus transaction duration
+};
+
+/* ------------------------------------------------------------ *
+ * BNO055 full data snapshot, decoded from one burst read of    *
+ * the contiguous data block 0x08-0x3B. All values come from    *
+ * the same sensor update. 0x3B UNIT_SEL is included so the     *
+ * gravity and linear acceleration scale needs no extra read.   *
+ * ------------------------------------------------------------ */
+#define SNAPSHOT_START       BNO055_ACC_DATA_X_LSB_ADDR
+#define SNAPSHOT_BYTECOUNT   (BNO055_UNIT_SEL_ADDR - SNAPSHOT_START + 1)
+
+struct bnosnap{
+   struct bnoacc acc;  // reg 0x08-0x0D accelerometer data
+   struct bnomag mag;  // reg 0x0E-0x13 magnetometer data
+   struct bnogyr gyr;  // reg 0x14-0x19 gyroscope data
+   struct bnoeul eul;  // reg 0x1A-0x1F Euler orientation
+   struct bnoqua qua;  // reg 0x20-0x27 quaternation data
+   struct bnolin lin;  // reg 0x28-0x2D linear acceleration
+   struct bnogra gra;  // reg 0x2E-0x33 gravity vector
+   char temp_val;      // reg 0x34 sensor temperature value
+   char scal_st;       // reg 0x35 system calibration state, 0-3
+   char gcal_st;       // reg 0x35 gyroscope calibration state
+   char acal_st;       // reg 0x35 accelerometer calibration state
+   char mcal_st;       // reg 0x35 magnetometer calibration state
+   char selftest;      // reg 0x36 self test result, lowest 4 bit
+   char intr_st;       // reg 0x37 interrupt status
+   char clk_st;        // reg 0x38 system clock status
+   char sys_stat;      // reg 0x39 system status, range 0-6
+   char sys_err;       // reg 0x3A system error code, 0=OK
+   char unitsel;       // reg 0x3B SI units definition
+   struct bnotime ts;  // one burst, also copied into the vectors
+   unsigned char raw[SNAPSHOT_BYTECOUNT]; // reg 0x08-0x3B as read
+};
+
+/* ------------------------------------------------------------ *
+ * Raw data access without floating point: the data registers   *
+ * 0x08-0x33 are 22 int16 channels in register order, followed  *
+ * by 8 status bytes 0x34-0x3B. A value is channel / divisor,   *
+ * see bno_raw_div(). get_raw() reads one group, a bnobatch     *
+ * (batch_bno055.c) collects samples into caller arrays, one    *
+ * per channel (struct of arrays), for bulk conversion.         *
+ * ------------------------------------------------------------ */
+#define BNO_RAW_CHANNELS     22    // int16 channels 0x08-0x33
+#define BNO_RAW_STATUS       8     // status bytes 0x34-0x3B
+#define BNO_CH_ACC           0     // acc X, Y, Z
+#define BNO_CH_MAG           3     // mag X, Y, Z
+#define BNO_CH_GYR           6     // gyr X, Y, Z
+#define BNO_CH_EUL           9     // Euler H, R, P
+#define BNO_CH_QUA           12    // quaternation W, X, Y, Z
+#define BNO_CH_LIN           16    // linear acc X, Y, Z
+#define BNO_CH_GRA           19    // gravity X, Y, Z
+
+/* ------------------------------------------------------------ *
+ * Data vector descriptors, one line per BNO_F_ vector in flag  *
+ * and register order. X(name, FLAG, first register, values,    *
+ * LSB per unit with UNIT_SEL bit-0 = 0, with bit-0 = 1, debug  *
+ * name, axis letters, struct bno<name> members). get_acc() to  *
+ * get_lin(), get_raw(), bno_raw_div(), bno_snap_decode() and   *
+ * the bnoframe codec are expanded from it, a new vector or a   *
+ * changed scale is a table edit.                               *
+ * ------------------------------------------------------------ */
+#define BNO_VECTORS(X) \
+   X(acc, ACC, BNO055_ACC_DATA_X_LSB_ADDR,        3, 1.0,     1.0,     "Accelerometer Data",  "XYZ",  adata_x, adata_y, adata_z) \
+   X(mag, MAG, BNO055_MAG_DATA_X_LSB_ADDR,        3, 1.6,     1.6,     "Magnetometer Data",   "XYZ",  mdata_x, mdata_y, mdata_z) \
+   X(gyr, GYR, BNO055_GYRO_DATA_X_LSB_ADDR,       3, 16.0,    16.0,    "Gyroscope Data",      "XYZ",  gdata_x, gdata_y, gdata_z) \
+   X(eul, EUL, BNO055_EULER_H_LSB_ADDR,           3, 16.0,    16.0,    "Euler Orientation",   "HRP",  eul_head, eul_roll, eul_pitc) \
+   X(qua, QUA, BNO055_QUATERNION_DATA_W_LSB_ADDR, 4, 16384.0, 16384.0, "Quaternation",        "WXYZ", quater_w, quater_x, quater_y, quater_z) \
+   X(lin, LIN, BNO055_LIN_ACC_DATA_X_LSB_ADDR,    3, 100.0,   1.0,     "Linear Acceleration", "XYZ",  linacc_x, linacc_y, linacc_z) \
+   X(gra, GRA, BNO055_GRAVITY_DATA_X_LSB_ADDR,    3, 100.0,   1.0,     "Gravity Vector",      "XYZ",  gravityx, gravityy, gravityz)
+
+/* ------------------------------------------------------------ *
+ * Copy the values of a vector struct from or to double v[],    *
+ * BNO_VEC_LOAD##n(struct ptr, v, members) in a table expansion *
+ * ------------------------------------------------------------ */
+#define BNO_VEC_LOAD3(s, v, a, b, c)     ((v)[0] = (s)->a, (v)[1] = (s)->b, (v)[2] = (s)->c)
+#define BNO_VEC_LOAD4(s, v, a, b, c, d)  (BNO_VEC_LOAD3(s, v, a, b, c), (v)[3] = (s)->d)
+#define BNO_VEC_STORE3(s, v, a, b, c)    ((s)->a = (v)[0], (s)->b = (v)[1], (s)->c = (v)[2])
+#define BNO_VEC_STORE4(s, v, a, b, c, d) (BNO_VEC_STORE3(s, v, a, b, c), (s)->d = (v)[3])
+
+struct bnoraw{
+   int16_t v[4];             // X, Y, Z, or W, X, Y, Z for quaternation
+   int n;                    // values used, 3 or 4
+   double div;               // LSB per unit, value = v[i] / div
+   struct bnotime ts;        // sample time and bus transaction duration
+};
+
+struct bnobatch{             // arrays set up by the caller
+   int size;                 // slots in each array
+   int count;                // samples stored, 0 = empty
+   int64_t *tstamp_ns;       // sample times, NULL = not kept
+   uint8_t *sensor;          // sensor indexes, NULL = not kept
+   int16_t *ch[BNO_RAW_CHANNELS];    // channel arrays, NULL = not kept
+   uint8_t *status[BNO_RAW_STATUS];  // status byte arrays, NULL = not kept
 };
 
+/* ------------------------------------------------------------ *
+ * Vectorized batch decoder (decode_bno055.c): register blocks  *
+ * straight into float channel arrays. BNO_DEC_AUTO selects the *
+ * best implementation for the CPU, the others are for testing. *
+ * ------------------------------------------------------------ */
+#define BNO_DEC_AUTO         0
+#define BNO_DEC_SCALAR       1
+#define BNO_DEC_SSE2         2     // x86
+#define BNO_DEC_AVX2         3     // x86, runtime CPU check
+#define BNO_DEC_NEON         4     // 64-bit ARM
+
+/* ------------------------------------------------------------ *
+ * Periodic sampler (tick_bno055.c), absolute deadlines without *
+ * drift. 100Hz is the fusion output rate, raw accelerometer    *
+ * data can update up to 1kHz depending on its bandwidth.       *
+ * ------------------------------------------------------------ */
+#define BNO_FUSION_HZ        100   // fusion data output rate
+#define BNO_TICK_MAX_HZ      1000  // max sampler rate, raw modes
+
+struct bnotick{
+   int64_t period_ns;        // sample period
+   int64_t next_ns;          // current deadline, CLOCK_MONOTONIC
+   unsigned long ticks;      // deadlines reached
+   unsigned long overruns;   // deadlines missed and skipped
+};
+
+/* ------------------------------------------------------------ *
+ * Multi-sensor acquisition (acq_bno055.c): one worker thread   *
+ * per bus, samples of all sensors end up in a common queue.    *
+ * ------------------------------------------------------------ */
+#define BNO_ACQ_MAX          8     // sensors (and buses) per engine
+#define BNO_ACQ_QUEUE        1024  // sample ring slots, power of 2
+
+struct bnosample{
+   int sensor;               // sensor index from bno_acq_add()
+   struct bnosnap snap;      // full data block, sample time in snap.ts
+};
+
+struct bnoacq;               // engine state, opaque
+
+/* ------------------------------------------------------------ *
+ * Lock-free sample rings (ring_bno055.c): single producer, or  *
+ * several producers (MPSC), and one consumer. Pushes never     *
+ * block, a full ring drops the new sample as an overrun.       *
+ * ------------------------------------------------------------ */
+#define BNO_RING_SPSC        0     // one producer thread
+#define BNO_RING_MPSC        1     // several producer threads
+
+struct bnoring;              // ring state, opaque
+
+/* ------------------------------------------------------------ *
+ * Binary capture files (cap_bno055.c): a 4KB header with the   *
+ * sensor setup, then fixed 64 byte records holding the raw     *
+ * data registers 0x08-0x3B. Every BNO_CAP_INDEX_EVERY-th slot  *
+ * is an index record, so a reader can binary search the time   *
+ * in an mmap()ed file. Host byte order, the sensors' int16     *
+ * values are little endian as read from the bus.               *
+ * Packed captures (encoding BNO_CAP_PACKED) hold blocks of     *
+ * index_every delta + varint coded records instead, see        *
+ * pack_bno055.c. Each block starts with a struct bnopackblk    *
+ * and keyframes, the reader walks the block headers at open.   *
+ * ------------------------------------------------------------ */
+#define BNO_CAP_MAGIC        "BNO055CP"
+#define BNO_CAP_VERSION      1
+#define BNO_CAP_HDRSIZE      4096  // records start page aligned
+#define BNO_CAP_INDEX_EVERY  1024  // index record slot interval
+#define BNO_REC_DATA         0     // record with sensor data
+#define BNO_REC_INDEX        1     // index record, see struct bnocapidx
+#define BNO_CAP_RAW          0     // encoding: fixed 64 byte records
+#define BNO_CAP_PACKED       1     // encoding: delta + varint blocks
+#define BNO_PACK_SYNC        0x4B4C4250  // "PBLK", block header marker
+#define BNO_PACK_RECMAX      96    // max bytes of one packed record
+
+struct bnorec{               // 64 bytes
+   int64_t  tstamp_ns;       // CLOCK_MONOTONIC_RAW sample time
+   uint8_t  type;            // BNO_REC_DATA or BNO_REC_INDEX
+   uint8_t  sensor;          // sensor index
+   uint16_t xfer_us;         // bus transaction time, capped at 65535
+   uint8_t  reg[SNAPSHOT_BYTECOUNT]; // raw registers 0x08-0x3B
+};
+
+struct bnocapidx{            // reg[] content of an index record
+   int64_t  realtime_ns;     // CLOCK_REALTIME when it was written
+   uint64_t datarecs;        // data records before this one
+   uint64_t dropped;         // samples lost to a full queue so far
+};
+
+struct bnocapsens{           // per-sensor setup at capture start
+   char    bus[64];          // bus name
+   uint8_t addr;             // I2C address
+   uint8_t opr_mode;         // reg 0x3D operation mode
+   uint8_t unit_sel;         // reg 0x3B units, scale of the raw data
+   uint8_t axr_conf;         // reg 0x41 axis remap
+   uint8_t axr_sign;         // reg 0x42 axis remap sign
+   uint8_t calib_st;         // reg 0x35 calibration state
+   uint8_t calset[CALIB_BYTECOUNT]; // calibration set, as by save_cal()
+};
+
+struct bnocaphdr{
+   char     magic[8];        // BNO_CAP_MAGIC
+   uint16_t version;         // BNO_CAP_VERSION
+   uint16_t hdrsize;         // BNO_CAP_HDRSIZE, records start here
+   uint16_t recsize;         // sizeof(struct bnorec)
+   uint16_t index_every;     // BNO_CAP_INDEX_EVERY
+   uint32_t nsensors;        // entries used in sens[]
+   uint32_t rate_mhz;        // acquisition rate in mHz, 0 = free run
+   int64_t  start_mono_ns;   // CLOCK_MONOTONIC_RAW at capture start
+   int64_t  start_real_ns;   // CLOCK_REALTIME at the same moment
+   uint8_t  regstart;        // first register in bnorec.reg, 0x08
+   uint8_t  reglen;          // register count in bnorec.reg
+   uint8_t  encoding;        // BNO_CAP_RAW or BNO_CAP_PACKED
+   uint8_t  reserved[5];
+   struct bnocapsens sens[BNO_ACQ_MAX];
+};
+
+struct bnopackblk{           // packed block header, 48 bytes
+   uint32_t sync;            // BNO_PACK_SYNC
+   uint32_t bytes;           // block size, this header included
+   uint32_t records;         // data records in the block
+   uint32_t reserved;
+   int64_t  tstamp_ns;       // first sample time, keyframe time base
+   struct bnocapidx idx;     // wall clock, records before, dropped
+};
+
+struct bnopack{              // delta codec state, encoder or decoder
+   int64_t  base_ns;                         // block time base
+   int64_t  tstamp[BNO_ACQ_MAX];             // last sample time
+   int64_t  dt[BNO_ACQ_MAX];                 // last sample interval
+   uint8_t  seen[BNO_ACQ_MAX];               // keyframe sent in block
+   uint8_t  reg[BNO_ACQ_MAX][SNAPSHOT_BYTECOUNT]; // last registers
+};
+
+struct bnocap;               // capture writer, opaque
+struct bnocapfile;           // mapped capture file, opaque
+
+/* ------------------------------------------------------------ *
+ * Shared memory publication (shm_bno055.c): the newest sample  *
+ * per sensor in a POSIX shm segment, seqlock protected. Reader *
+ * processes link only libbno055shm.so.                         *
+ * ------------------------------------------------------------ */
+#define BNO_SHM_NAME         "/bno055" // default segment name
+
+struct bnoshm;               // mapped segment, opaque
+
+/* ------------------------------------------------------------ *
+ * bno055d daemon protocol (sub_bno055.c). Clients send a       *
+ * bnosubreq, the daemon answers with one frame per sample: a   *
+ * bnoframe header, then the selected fields in BNO_F_ order,   *
+ * vectors as float, BNO_F_STAT as 8 bytes: temp, the 4 calib   *
+ * states, sys_stat, sys_err, unitsel. Host byte order.         *
+ * ------------------------------------------------------------ */
+#define BNO_SOCK_PATH        "/tmp/bno055.sock" // default socket
+#define BNO_SUB_MAX          32    // clients per daemon
+#define BNO_FRAME_MAX        128   // largest frame, all fields
+
+#define BNO_F_ACC            0x0001 // accelerometer, 3 float
+#define BNO_F_MAG            0x0002 // magnetometer, 3 float
+#define BNO_F_GYR            0x0004 // gyroscope, 3 float
+#define BNO_F_EUL            0x0008 // Euler angles, 3 float
+#define BNO_F_QUA            0x0010 // quaternation, 4 float
+#define BNO_F_LIN            0x0020 // linear acceleration, 3 float
+#define BNO_F_GRA            0x0040 // gravity vector, 3 float
+#define BNO_F_STAT           0x0080 // temperature and status, 8 byte
+#define BNO_F_ALL            0x00FF
+
+struct bnosubreq{            // client -> daemon, 8 bytes
+   uint16_t fields;          // BNO_F_ mask, 0 = pause
+   uint16_t rate;            // frames/s per sensor, 0 = every sample
+   uint32_t sensors;         // bitmask of sensor indexes, 0 = all
+};
+
+struct bnoframe{             // daemon -> client frame header, 24 bytes
+   uint16_t len;             // frame length, header included
+   uint16_t fields;          // BNO_F_ mask of the payload
+   uint8_t  sensor;          // sensor index
+   uint8_t  reserved;
+   uint16_t xfer_us;         // bus transaction time, capped at 65535
+   uint32_t seq;             // frame counter of this client
+   uint32_t dropped;         // frames dropped so far, client too slow
+   int64_t  tstamp_ns;       // CLOCK_MONOTONIC_RAW sample time
+};
+
+/* ------------------------------------------------------------ *
+ * Sample output formatters (out_bno055.c). The BNO_F_ mask     *
+ * selects the columns, BNO_OUT_HEAD adds sensor index, sample  *
+ * time and transfer time. Rows are buffered and written in     *
+ * batches, at most BNO_OUT_LATENCY_MS late. HTML files are     *
+ * replaced by rename(), a bnohtml only writes changed pages.   *
+ * ------------------------------------------------------------ */
+#define BNO_OUT_TEXT         0     // "-t" lines, "ACC x y z"
+#define BNO_OUT_CSV          1     // comma separated, header row
+#define BNO_OUT_JSON         2     // JSON Lines, one object per row
+#define BNO_OUT_BIN          3     // bno055d frames, bno_frame_decode()
+#define BNO_OUT_HEAD         0x8000 // fields flag: sensor and time
+#define BNO_OUT_BUFSIZE      65536 // output buffer size
+#define BNO_OUT_LATENCY_MS   100   // max delay of a buffered row
+#define BNO_HTML_HZ          1     // default max HTML file writes/s
+
+struct bnoout;               // formatter state, opaque
+struct bnohtml;              // change-driven HTML file, opaque
+
+/* ------------------------------------------------------------ *
+ * Asynchronous access (aio_bno055.c): requests are queued to a *
+ * dedicated I/O thread, results come back as a callback or as  *
+ * completion entries, signalled through a poll()-able eventfd. *
+ * ------------------------------------------------------------ */
+#define BNO_AIO_DEPTH        64    // max requests in flight
+
+typedef enum {
+   bno_op_read     = 0,    // bno_read_regs(reg, buf, len)
+   bno_op_write    = 1,    // bno_write_regs(reg, buf, len)
+   bno_op_snapshot = 2,    // get_snapshot(buf = struct bnosnap*)
+   bno_op_mode     = 3,    // set_mode(arg = opmode_t)
+   bno_op_power    = 4,    // set_power(arg = power_t)
+   bno_op_reset    = 5     // bno_reset()
+} bnoop_t;
+
+struct bnoreq{
+   bnoop_t op;               // operation to run
+   unsigned char reg;        // first register, read/write
+   int len;                  // byte count, read/write
+   void *buf;                // data buffer, valid until completion
+   int arg;                  // mode value for bno_op_mode/power
+   void (*callback)(void*, int); // optional, runs on the I/O thread
+   void *user;               // caller cookie for callback/completion
+};
+
+struct bnocqe{
+   bnoop_t op;               // operation that completed
+   int res;                  // its return code, 0 = OK, -1 = Error
+   void *user;               // cookie from the request
+};
+
+struct bnoaio;               // I/O thread state, opaque
+
 /* ------------------------------------------------------------ *
  * BNO055 accelerometer gyroscope magnetometer config structs   *
  * ------------------------------------------------------------ */
@@ -310,43 +826,143 @@ typedef enum {
 /* ------------------------------------------------------------ *
  * external function prototypes for I2C bus communication code  *
  * ------------------------------------------------------------ */
-extern void get_i2cbus(char*, char*);     // get the I2C bus file handle
-extern int set_page0();                   // set register map page 0
-extern int set_page1();                   // set register map page 1
-extern int get_calstatus(struct bnocal*); // read calibration status
-extern int get_caloffset(struct bnocal*); // read calibration values
-extern int get_inf(struct bnoinf*);       // read sensor information
-extern int get_acc(struct bnoacc*);       // read accelerometer data
-extern int get_mag(struct bnomag*);       // read magnetometer data
-extern int get_gyr(struct bnogyr*);       // read gyroscope data
-extern int get_eul(struct bnoeul*);       // read euler orientation
-extern int get_qua(struct bnoqua*);       // read quaternation data
-extern int get_gra(struct bnogra*);       // read gravity data
-extern int get_lin(struct bnolin*);       // read linar acceleration data
-extern int get_clksrc();                  // get the clock source setting
-extern void print_clksrc();               // print clock source setting
-extern int set_mode(opmode_t);            // set the sensor ops mode
-extern int get_mode();                    // get the sensor ops mode
+extern bno055_t *bno_open(const char*, const char*, int); // open bus, addr, verbose
+extern void bno_close(bno055_t*);         // close bus, free the handle
+extern const struct bnotransport *bno_transport_for(const char*); // bus name->backend
+extern struct bnopty *bno_pty_open(const char*, int); // "sim[:<ppm>]" UART stand-in, verbose
+extern const char *bno_pty_name(struct bnopty*); // its slave tty path
+extern void bno_pty_close(struct bnopty*);   // stop the responder
+extern int bno_read_regs(bno055_t*, unsigned char, void*, int); // read register block
+extern int bno_read_multi(bno055_t*, struct bnoxfer*, int); // read several blocks
+extern int bno_write_regs(bno055_t*, unsigned char, const void*, int); // write register block
+extern int bno_write_reg(bno055_t*, unsigned char, unsigned char); // write one register
+extern int bno_errclass(int);            // errno -> BNO_E_ class
+extern const char *bno_errclass_name(int); // BNO_E_ class name
+extern int bno_err_transient(int);       // 1 = BNO_E_ class is retried
+extern int bno_retry_set(bno055_t*, int, long, long); // retries, first and max backoff us
+extern void bno_log(int, const char*, ...) __attribute__((format(printf, 2, 3))); // BNO_LOG_ level
+extern void bno_log_set(bno_logfn);      // message handler, NULL = stdout/stderr
+extern int bno_trace_start(bno055_t*, int); // keep the last n transactions
+extern void bno_trace_stop(bno055_t*);   // stop tracing, free the ring
+extern int bno_trace_dump(bno055_t*, int); // print the ring to fd, oldest first
+extern int bno_errs_dump(bno055_t*, int); // print the error counters to fd
+extern void bno_trace_rec(bno055_t*, int, unsigned char, int, int, int, const struct timespec*); // op, reg, len, count, result, start
+extern int set_page0(bno055_t*);          // set register map page 0
+extern int set_page1(bno055_t*);          // set register map page 1
+extern int get_calstatus(bno055_t*, struct bnocal*); // read calibration status
+extern int get_caloffset(bno055_t*, struct bnocal*); // read calibration values
+extern int get_inf(bno055_t*, struct bnoinf*); // read sensor information
+extern int get_acc(bno055_t*, struct bnoacc*); // read accelerometer data
+extern int get_mag(bno055_t*, struct bnomag*); // read magnetometer data
+extern int get_gyr(bno055_t*, struct bnogyr*); // read gyroscope data
+extern int get_eul(bno055_t*, struct bnoeul*); // read euler orientation
+extern int get_qua(bno055_t*, struct bnoqua*); // read quaternation data
+extern int get_gra(bno055_t*, struct bnogra*); // read gravity data
+extern int get_lin(bno055_t*, struct bnolin*); // read linar acceleration data
+extern int get_snapshot(bno055_t*, struct bnosnap*); // read all data in one burst
+extern void bno_snap_decode(const unsigned char*, struct bnosnap*); // raw 0x08-0x3B
+extern int get_raw(bno055_t*, uint16_t, struct bnoraw*); // one BNO_F_ group as int16
+extern double bno_raw_div(int, unsigned char); // channel, unit_sel: LSB per unit
+extern int bno_batch_add(struct bnobatch*, const unsigned char*, int, int64_t); // reg, sensor, time
+extern int bno_batch_sample(struct bnobatch*, const struct bnosample*); // -1 = full
+extern long bno_batch_cap(struct bnobatch*, struct bnocapfile*, long); // fill from slot, next slot
+extern void bno_batch_scale(const int16_t*, double*, int, double); // bulk raw / div
+extern void bno_decode_batch(const unsigned char*, int, int, float**); // regs, stride, n, out[22]
+extern int bno_decode_select(int);     // BNO_DEC_ implementation, -1 = unsupported
+extern const char *bno_decode_name();  // implementation in use
+extern void bno_shadow_invalidate(bno055_t*); // drop the register shadow
+extern int bno_shadow_load(bno055_t*, int); // read shadow block of page 0/1
+extern int bno_shadow_get(bno055_t*, int, unsigned char); // shadowed register value
+extern int get_clksrc(bno055_t*);         // get the clock source setting
+extern void print_clksrc(bno055_t*);      // print clock source setting
+extern int set_mode(bno055_t*, opmode_t); // set the sensor ops mode
+extern int get_mode(bno055_t*);           // get the sensor ops mode
 extern int print_mode(int);               // print ops mode string
 extern void print_unit(int);              // print SI unit configuration
-extern int set_power(power_t);            // set the sensor power mode
-extern int get_power();                   // get the sensor power mode
+extern int set_power(bno055_t*, power_t); // set the sensor power mode
+extern int get_power(bno055_t*);          // get the sensor power mode
 extern int print_power(int);              // print power mode string
-extern int get_sstat();                   // get system status code
+extern int get_sstat(bno055_t*);          // get system status code
 extern int print_sstat(int);              // print system status string
-extern int get_remap(char);               // get the axis remap values
+extern int get_remap(bno055_t*, char);    // get the axis remap values
 extern int print_remap_conf(int);         // print axis configuration
 extern int print_remap_sign(int);         // print the axis remap +/-
-extern int bno_dump();                    // dump the register map data
-extern int bno_reset();                   // reset the sensor
-extern int save_cal(char*);               // write calibration to file
-extern int load_cal(char*);               // load calibration from file
-extern int get_acc_conf(struct bnoaconf*);// get accelerometer config
-extern int get_mag_conf(struct bnomconf*);// get magnetometer config
-extern int get_gyr_conf(struct bnogconf*);// get gyroscope config
-extern int set_acc_conf();                // set accelerometer config
-extern int set_mag_conf();                // set magnetometer config
-extern int set_gyr_conf();                // set gyroscope config
-extern void print_acc_conf();             // print accelerometer config
-extern void print_mag_conf();             // print magnetometer config
-extern void print_gyr_conf();             // print gyroscope config
+extern int bno_dump(bno055_t*);           // dump the register map data
+extern int bno_reset(bno055_t*);          // reset the sensor
+extern int get_calset(bno055_t*, unsigned char*); // read calibration set
+extern int save_cal(bno055_t*, char*);    // write calibration to file
+extern int load_cal(bno055_t*, char*);    // load calibration from file
+extern int get_conf(bno055_t*, struct bnoaconf*, struct bnomconf*, struct bnogconf*); // page-1 configs
+extern int get_acc_conf(bno055_t*, struct bnoaconf*); // get accelerometer config
+extern int get_mag_conf(bno055_t*, struct bnomconf*); // get magnetometer config
+extern int get_gyr_conf(bno055_t*, struct bnogconf*); // get gyroscope config
+extern int set_acc_conf(bno055_t*);       // set accelerometer config
+extern int set_mag_conf(bno055_t*);       // set magnetometer config
+extern int set_gyr_conf(bno055_t*);       // set gyroscope config
+extern void print_acc_conf(struct bnoaconf*); // print accelerometer config
+extern void print_mag_conf(struct bnomconf*); // print magnetometer config
+extern void print_gyr_conf(struct bnogconf*); // print gyroscope config
+extern int set_intr(bno055_t*, int);         // enable interrupts, INT pin mask
+extern int get_intr(bno055_t*);              // read INTR_STAT
+extern int bno_irq_open(bno055_t*, const char*); // INT line, gpiochip:offset
+extern int bno_irq_wait(bno055_t*, int);     // wait for the INT edge, ms
+extern int bno_irq_clear(bno055_t*);         // RST_INT, release the INT pin
+extern void bno_irq_close(bno055_t*);        // release the INT line
+extern int bno_tick_init(struct bnotick*, double); // start sampler at rate hz
+extern int bno_tick_wait(struct bnotick*);  // sleep to next deadline, missed
+extern struct bnoacq *bno_acq_new(double, int); // new engine, rate hz, verbose
+extern int bno_acq_add(struct bnoacq*, const char*, const char*); // add bus, addr
+extern bno055_t *bno_acq_dev(struct bnoacq*, int); // handle of sensor index
+extern int bno_acq_start(struct bnoacq*);     // start the bus workers
+extern int bno_acq_read(struct bnoacq*, struct bnosample*, int); // next sample, ms
+extern unsigned long bno_acq_dropped(struct bnoacq*); // ring overflow count
+extern int bno_acq_active(struct bnoacq*);            // workers still running
+extern unsigned long bno_acq_overruns(struct bnoacq*); // missed sweep deadlines
+extern void bno_acq_stop(struct bnoacq*);     // stop the bus workers
+extern void bno_acq_close(struct bnoacq*);    // stop, close all sensors
+extern struct bnoring *bno_ring_new(unsigned, int); // slots (2^n), SPSC/MPSC
+extern int bno_ring_push(struct bnoring*, const struct bnosample*); // -1 = full
+extern int bno_ring_push_wait(struct bnoring*, const struct bnosample*, const int*); // waits for room
+extern int bno_ring_pop(struct bnoring*, struct bnosample*); // -1 = empty
+extern int bno_ring_read(struct bnoring*, struct bnosample*, int); // wait up to ms
+extern unsigned long bno_ring_overruns(struct bnoring*); // dropped, ring full
+extern void bno_ring_free(struct bnoring*);   // release the ring
+extern struct bnoshm *bno_shm_create(const char*, int); // publisher, name, verbose
+extern int bno_shm_publish(struct bnoshm*, const struct bnosample*); // newest sample
+extern struct bnoshm *bno_shm_open(const char*); // reader, maps read-only
+extern long bno_shm_read(struct bnoshm*, int, struct bnosample*); // sensor, count
+extern void bno_shm_close(struct bnoshm*);    // unmap, publisher unlinks
+extern int bno_frame_size(uint16_t);          // frame length for BNO_F_ mask
+extern int bno_frame_encode(const struct bnosample*, uint16_t, unsigned char*); // daemon
+extern int bno_frame_decode(const unsigned char*, int, struct bnoframe*, struct bnosample*);
+extern int bno_sub_connect(const char*);      // connect to bno055d, NULL = default
+extern int bno_sub_request(int, uint16_t, uint32_t, uint16_t); // fields, sensors, hz
+extern int bno_sub_read(int, struct bnoframe*, struct bnosample*); // next frame
+extern struct bnocap *bno_cap_create(const char*, double, int, int); // file, hz, encoding, verbose
+extern int bno_cap_sensor(struct bnocap*, bno055_t*, const char*); // add setup, bus
+extern int bno_cap_write(struct bnocap*, const struct bnosample*, unsigned long);
+extern int bno_cap_close(struct bnocap*);     // flush and close the file
+extern struct bnocapfile *bno_cap_open(const char*); // map a capture read-only
+extern const struct bnocaphdr *bno_cap_header(struct bnocapfile*); // its setup
+extern long bno_cap_slots(struct bnocapfile*); // record slots, index included
+extern const struct bnorec *bno_cap_rec(struct bnocapfile*, long); // slot n, valid to next call
+extern long bno_cap_seek(struct bnocapfile*, int64_t); // first slot at/after time
+extern int bno_cap_sample(struct bnocapfile*, long, struct bnosample*); // decode
+extern void bno_cap_unmap(struct bnocapfile*); // release the mapping
+extern void bno_pack_reset(struct bnopack*, int64_t); // new keyframe block, base
+extern int bno_pack_rec(struct bnopack*, const struct bnorec*, unsigned char*); // encode
+extern int bno_unpack_rec(struct bnopack*, const unsigned char*, int, struct bnorec*); // decode
+extern int bno_out_format(const char*);       // "text", "csv", "json", "bin", -1 = unknown
+extern struct bnoout *bno_out_open(int, int, uint16_t); // fd, format, fields
+extern int bno_out_sample(struct bnoout*, const struct bnosample*); // buffered row
+extern int bno_out_flush(struct bnoout*);     // write the buffered rows
+extern int bno_out_close(struct bnoout*);     // flush and free
+extern int bno_out_html(const char*, const struct bnosnap*, uint16_t); // file, data, fields
+extern struct bnohtml *bno_html_open(const char*, uint16_t, double, double, int); // file, fields, deadband, hz, verbose
+extern int bno_html_update(struct bnohtml*, const struct bnosnap*); // 1 = written, 0 = skipped
+extern int bno_html_close(struct bnohtml*);   // write a held back change, free
+extern struct bnoaio *bno_aio_start(bno055_t*); // start the I/O thread
+extern int bno_aio_submit(struct bnoaio*, const struct bnoreq*); // queue request
+extern int bno_aio_fd(struct bnoaio*);        // completion eventfd for poll()
+extern int bno_aio_reap(struct bnoaio*, struct bnocqe*, int, int); // get completions
+extern void bno_aio_stop(struct bnoaio*);     // drain queue, stop the thread
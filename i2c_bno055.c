@@ -12,152 +12,655 @@
  * ------------------------------------------------------------ */
 #include <stdio.h>
 #include <stdlib.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
 #include "getbno055.h"
 
 /* ------------------------------------------------------------ *
- * get_i2cbus() - Enables the I2C bus communication. Raspberry  *
- * Pi 2 uses i2c-1, RPI 1 used i2c-0, NanoPi also uses i2c-0.   *
+ * Linux i2c-dev backend state: the bus fd and the sensor slave *
+ * address, which goes into every I2C_RDWR message.             *
  * ------------------------------------------------------------ */
-void get_i2cbus(char *i2cbus, char *i2caddr) {
+struct i2cdev{
+   int fd;        // I2C bus file descriptor
+   int addr;      // sensor I2C address
+};
+
+static int i2cdev_open(struct bnotransport *t, const char *i2cbus, int addr) {
+   struct i2cdev *dev = malloc(sizeof(struct i2cdev));
+   if(dev == NULL) return(-1);
+
+   if((dev->fd = open(i2cbus, O_RDWR)) < 0) {
+      BNO_ERROR("Error failed to open I2C bus [%s].\n", i2cbus);
+      free(dev);
+      return(-1);
+   }
+   BNO_DEBUG(t->verbose, "Debug: I2C bus device: [%s]\n", i2cbus);
+
+   if(ioctl(dev->fd, I2C_SLAVE, addr) != 0) {
+      BNO_ERROR("Error can't find sensor at address [0x%02X].\n", addr);
+      close(dev->fd);
+      free(dev);
+      return(-1);
+   }
+   dev->addr = addr;
+   t->priv = dev;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * i2cdev_read_multi() - reads several register blocks with one *
+ * I2C_RDWR ioctl. Each block is a register pointer write plus  *
+ * a read, joined by a repeated start instead of a STOP. The    *
+ * kernel caps the message count per ioctl, bigger batches are  *
+ * split into chunks of BNO_XFER_MAX blocks.                    *
+ * ------------------------------------------------------------ */
+static int i2cdev_read_multi(struct bnotransport *t, struct bnoxfer *xfer, int count) {
+   struct i2cdev *dev = t->priv;
+   struct i2c_msg msgs[2 * BNO_XFER_MAX];
+   struct i2c_rdwr_ioctl_data rdwr;
+   int done = 0;
+
+   while(done < count) {
+      int n = count - done;
+      if(n > BNO_XFER_MAX) n = BNO_XFER_MAX;
+
+      int i;
+      for(i = 0; i < n; i++) {
+         struct bnoxfer *x = &xfer[done + i];
+         msgs[2*i].addr    = dev->addr;
+         msgs[2*i].flags   = 0;
+         msgs[2*i].len     = 1;
+         msgs[2*i].buf     = &x->reg;
+         msgs[2*i+1].addr  = dev->addr;
+         msgs[2*i+1].flags = I2C_M_RD;
+         msgs[2*i+1].len   = x->len;
+         msgs[2*i+1].buf   = x->buf;
+      }
+      rdwr.msgs  = msgs;
+      rdwr.nmsgs = 2 * n;
+
+      int res = ioctl(dev->fd, I2C_RDWR, &rdwr);
+      if(res != 2 * n) {
+         if(res >= 0) errno = EIO;      // partial transfer, errno not set
+         return(-1);
+      }
+      done += n;
+   }
+   return(0);
+}
+
+static int i2cdev_read_regs(struct bnotransport *t, unsigned char reg, void *buf, int len) {
+   struct bnoxfer xfer = { reg, len, buf };
+   return i2cdev_read_multi(t, &xfer, 1);
+}
+
+/* ------------------------------------------------------------ *
+ * i2cdev_write_regs() - writes len bytes starting at register  *
+ * reg as one I2C message: register pointer followed by data.   *
+ * ------------------------------------------------------------ */
+static int i2cdev_write_regs(struct bnotransport *t, unsigned char reg, const void *buf, int len) {
+   struct i2cdev *dev = t->priv;
+   unsigned char data[REGISTERMAP_END + 2];
+   struct i2c_msg msg;
+   struct i2c_rdwr_ioctl_data rdwr;
+
+   if(len < 0 || len > REGISTERMAP_END + 1) {
+      errno = EINVAL;
+      return(-1);
+   }
+   data[0] = reg;
+   memcpy(&data[1], buf, len);
+
+   msg.addr  = dev->addr;
+   msg.flags = 0;
+   msg.len   = len + 1;
+   msg.buf   = data;
+   rdwr.msgs  = &msg;
+   rdwr.nmsgs = 1;
+
+   int res = ioctl(dev->fd, I2C_RDWR, &rdwr);
+   if(res != 1) {
+      if(res >= 0) errno = EIO;
+      return(-1);
+   }
+   return(0);
+}
+
+static void i2cdev_close(struct bnotransport *t) {
+   struct i2cdev *dev = t->priv;
+   if(dev == NULL) return;
+   close(dev->fd);
+   free(dev);
+   t->priv = NULL;
+}
+
+const struct bnotransport bno_i2cdev_transport = {
+   "i2c-dev",
+   i2cdev_open,
+   i2cdev_read_regs,
+   i2cdev_read_multi,
+   i2cdev_write_regs,
+   i2cdev_close,
+   NULL,
+   NULL,
+   NULL
+};
+
+/* ------------------------------------------------------------ *
+ * bno_transport_for() - pick the backend from the bus name:    *
+ * "sim" or "sim:<hz>" is the simulated sensor, "replay:<file>" *
+ * or "replay-rt:<file>" plays a capture file back, serial ports*
+ * (/dev/tty*, /dev/serial*, uart:<path>) use the UART protocol,*
+ * anything else is an i2c-dev device node such as /dev/i2c-1.  *
+ * ------------------------------------------------------------ */
+const struct bnotransport *bno_transport_for(const char *i2cbus) {
+   if(strncmp(i2cbus, "sim", 3) == 0) return &bno_sim_transport;
+   if(strncmp(i2cbus, "replay:", 7) == 0
+      || strncmp(i2cbus, "replay-rt:", 10) == 0) return &bno_replay_transport;
+   if(strncmp(i2cbus, "uart:", 5) == 0
+      || strncmp(i2cbus, "/dev/tty", 8) == 0
+      || strncmp(i2cbus, "/dev/serial", 11) == 0) return &bno_uart_transport;
+   return &bno_i2cdev_transport;
+}
+
+/* ------------------------------------------------------------ *
+ * shadow_slot() - returns the shadow byte for register reg on  *
+ * page pg, or NULL if the register is not shadowed. SYS_TRIGGER*
+ * is skipped, its reset and self test bits clear themselves.   *
+ * ------------------------------------------------------------ */
+static unsigned char *shadow_slot(bno055_t *bno, int pg, int reg) {
+   if(pg == 0 && reg >= SHADOW_P0_START && reg <= SHADOW_P0_END
+      && reg != BNO055_SYS_TRIGGER_ADDR) return &bno->shadow.p0[reg - SHADOW_P0_START];
+   if(pg == 1 && reg >= SHADOW_P1_START && reg <= SHADOW_P1_END)
+      return &bno->shadow.p1[reg - SHADOW_P1_START];
+   return NULL;
+}
+
+/* ------------------------------------------------------------ *
+ * shadow_fill() - register data read from the sensor is always *
+ * current, copy any shadowed registers it covers.              *
+ * ------------------------------------------------------------ */
+static void shadow_fill(bno055_t *bno, unsigned char reg, const void *buf, int len) {
+   const unsigned char *data = buf;
+   int i;
+   if(bno->shadow.page < 0) return;
+   for(i = 0; i < len; i++) {
+      if(reg + i == BNO055_PAGE_ID_ADDR) bno->shadow.page = data[i] & 0x01;
+      unsigned char *slot = shadow_slot(bno, bno->shadow.page, reg + i);
+      if(slot != NULL) *slot = data[i];
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * shadow_write() - track our own register writes. The sensor   *
+ * ignores config register writes outside of CONFIG mode, so    *
+ * then the block is invalidated instead, to be read back next  *
+ * time. A system reset (SYS_TRIGGER bit-5) drops everything.   *
+ * ------------------------------------------------------------ */
+static void shadow_write(bno055_t *bno, unsigned char reg, const void *buf, int len) {
+   const unsigned char *data = buf;
+   int i;
+   for(i = 0; i < len; i++) {
+      int r = reg + i;
+      if(r == BNO055_PAGE_ID_ADDR) {
+         bno->shadow.page = data[i] & 0x01;
+         continue;
+      }
+      if(bno->shadow.page == 0 && r == BNO055_SYS_TRIGGER_ADDR && (data[i] & 0x20)) {
+         bno_shadow_invalidate(bno);
+         return;
+      }
+      if(bno->shadow.page < 0) continue;
+      unsigned char *slot = shadow_slot(bno, bno->shadow.page, r);
+      if(slot == NULL) continue;
 
-   if((i2cfd = open(i2cbus, O_RDWR)) < 0) {
-      printf("Error failed to open I2C bus [%s].\n", i2cbus);
-      exit(-1);
+      int cfgmode = bno->shadow.valid[0] && (bno->shadow.p0[BNO055_OPR_MODE_ADDR - SHADOW_P0_START] & 0x0F) == config;
+      if(bno->shadow.page == 0 && r == BNO055_OPR_MODE_ADDR) *slot = data[i];
+      else if(cfgmode) *slot = data[i];
+      else bno->shadow.valid[bno->shadow.page] = 0;
    }
-   if(verbose == 1) printf("Debug: I2C bus device: [%s]\n", i2cbus);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shadow_invalidate() - forget all shadowed register data, *
+ * e.g. after a reset or if another program changed the sensor. *
+ * ------------------------------------------------------------ */
+void bno_shadow_invalidate(bno055_t *bno) {
+   bno->shadow.page = -1;
+   bno->shadow.valid[0] = 0;
+   bno->shadow.valid[1] = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shadow_load() - read the shadowed register block of page *
+ * pg from the sensor with one burst. Page-1 needs a switch to  *
+ * page 1 and back to page 0.                                   *
+ * ------------------------------------------------------------ */
+int bno_shadow_load(bno055_t *bno, int pg) {
+   unsigned char data[SHADOW_P1_END - SHADOW_P1_START + 1];
+
+   if(bno->shadow.page != 0 && set_page0(bno) != 0) return(-1);
+   if(pg == 0) {
+      if(bno_read_regs(bno, SHADOW_P0_START, data, SHADOW_P0_END - SHADOW_P0_START + 1) != 0) return(-1);
+      bno->shadow.valid[0] = 1;
+      return(0);
+   }
+
+   if(set_page1(bno) != 0) return(-1);
+   int res = bno_read_regs(bno, SHADOW_P1_START, data, SHADOW_P1_END - SHADOW_P1_START + 1);
+   if(set_page0(bno) != 0) return(-1);
+   if(res != 0) return(-1);
+   bno->shadow.valid[1] = 1;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shadow_get() - returns a shadowed register value, loads  *
+ * the page block first if needed. Returns -1 on errors or for  *
+ * registers that are not shadowed.                             *
+ * ------------------------------------------------------------ */
+int bno_shadow_get(bno055_t *bno, int pg, unsigned char reg) {
+   unsigned char *slot = shadow_slot(bno, pg, reg);
+   if(slot == NULL) return(-1);
+   if(!bno->shadow.valid[pg] && bno_shadow_load(bno, pg) != 0) return(-1);
+   return *slot;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_open() - opens the bus to the sensor and returns a new   *
+ * device handle, or NULL on errors. Raspberry Pi 2 uses i2c-1, *
+ * RPI 1 used i2c-0, NanoPi also uses i2c-0. Each handle has    *
+ * its own bus connection and register shadow, so several       *
+ * sensors can be used side by side, one thread per handle.     *
+ * ------------------------------------------------------------ */
+bno055_t *bno_open(const char *i2cbus, const char *i2caddr, int verbose) {
+   bno055_t *bno = calloc(1, sizeof(bno055_t));
+   if(bno == NULL) {
+      BNO_ERROR("Error: cannot allocate the device handle.\n");
+      return(NULL);
+   }
+   bno->verbose = verbose;
+   bno->shadow.page = -1;
+   bno->irqfd = -1;
+   bno->retry.max = BNO_RETRY_MAX;
+   bno->retry.delay_us = BNO_RETRY_US;
+   bno->retry.delay_max_us = BNO_RETRY_MAX_US;
+
    /* --------------------------------------------------------- *
     * Set I2C device (BNO055 I2C address is  0x28 or 0x29)      *
     * --------------------------------------------------------- */
-   int addr = (int)strtol(i2caddr, NULL, 16);
-   if(verbose == 1) printf("Debug: Sensor address: [0x%02X]\n", addr);
+   bno->addr = (int)strtol(i2caddr, NULL, 16);
+   BNO_DEBUG(bno->verbose, "Debug: Sensor address: [0x%02X]\n", bno->addr);
 
-   if(ioctl(i2cfd, I2C_SLAVE, addr) != 0) {
-      printf("Error can't find sensor at address [0x%02X].\n", addr);
-      exit(-1);
+   bno->bus = *bno_transport_for(i2cbus);
+   bno->bus.verbose = verbose;
+   BNO_DEBUG(bno->verbose, "Debug: Bus transport: [%s]\n", bno->bus.name);
+   if(bno->bus.open(&bno->bus, i2cbus, bno->addr) != 0) {
+      free(bno);
+      return(NULL);
    }
+
    /* --------------------------------------------------------- *
     * I2C communication test is the only way to confirm success *
     * --------------------------------------------------------- */
-   char reg = BNO055_CHIP_ID_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure register [0x%02X], sensor addr [0x%02X]?\n", reg, addr);
-      exit(-1);
+   unsigned char chip_id;
+   if(bno_read_regs(bno, BNO055_CHIP_ID_ADDR, &chip_id, 1) != 0) {
+      BNO_ERROR("Error: I2C read failure register [0x%02X], sensor addr [0x%02X]?\n",
+             BNO055_CHIP_ID_ADDR, bno->addr);
+      bno_close(bno);
+      return(NULL);
+   }
+
+   /* --------------------------------------------------------- *
+    * Populate the page-0 configuration register shadow once    *
+    * --------------------------------------------------------- */
+   if(bno_shadow_load(bno, 0) != 0) {
+      bno_close(bno);
+      return(NULL);
+   }
+   return(bno);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_close() - release the bus and free the device handle     *
+ * ------------------------------------------------------------ */
+void bno_close(bno055_t *bno) {
+   if(bno == NULL) return;
+   bno_trace_stop(bno);
+   bno_irq_close(bno);
+   if(bno->bus.close != NULL) bno->bus.close(&bno->bus);
+   free(bno);
+}
+
+/* ------------------------------------------------------------ *
+ * xfer_stamp() - record the timing of a read transaction that  *
+ * started at t0: its midpoint as sample time, and its duration.*
+ * A backend with recorded data supplies the recorded timing.   *
+ * ------------------------------------------------------------ */
+static void xfer_stamp(bno055_t *bno, const struct timespec *t0) {
+   long dur;
+   if(bno->bus.stamp != NULL && bno->bus.stamp(&bno->bus, &bno->xfer) == 0) {
+      dur = bno->xfer.xfer_ns;
+   }
+   else {
+      struct timespec t1;
+      clock_gettime(CLOCK_MONOTONIC_RAW, &t1);
+
+      dur = (t1.tv_sec - t0->tv_sec) * 1000000000L + (t1.tv_nsec - t0->tv_nsec);
+      bno->xfer.xfer_ns = dur;
+      bno->xfer.tstamp.tv_sec  = t0->tv_sec;
+      bno->xfer.tstamp.tv_nsec = t0->tv_nsec + dur / 2;
+      while(bno->xfer.tstamp.tv_nsec >= 1000000000L) {
+         bno->xfer.tstamp.tv_nsec -= 1000000000L;
+         bno->xfer.tstamp.tv_sec++;
+      }
+   }
+   if(dur > bno->xfer_max_ns) bno->xfer_max_ns = dur;
+   BNO_DEBUG(bno->verbose, "Debug: Bus transaction took %ld us\n", dur / 1000);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_errclass() - sort an errno value of a failed transaction *
+ * into its BNO_E_ class                                        *
+ * ------------------------------------------------------------ */
+int bno_errclass(int errnum) {
+   switch(errnum) {
+      case 0:         return(BNO_E_OK);
+      case EREMOTEIO:
+      case ENXIO:     return(BNO_E_NACK);      // i2c-dev: no ACK from the address
+      case ETIMEDOUT: return(BNO_E_TIMEOUT);
+      case EIO:
+      case EAGAIN:                             // i2c-dev: arbitration lost
+      case EBUSY:
+      case EPROTO:
+      case EINTR:     return(BNO_E_BUS);
+      case ENODEV:
+      case ENOENT:
+      case EBADF:
+      case ENOTTY:
+      case EACCES:
+      case EOPNOTSUPP: return(BNO_E_NODEV);
+      case ENODATA:   return(BNO_E_NODATA);
+      default:        return(BNO_E_OTHER);
+   }
+}
+
+const char *bno_errclass_name(int cls) {
+   static const char *names[BNO_E_CLASSES] = { "ok", "nack", "timeout", "bus", "nodev", "nodata", "other" };
+   if(cls < 0 || cls >= BNO_E_CLASSES) return("unknown");
+   return(names[cls]);
+}
+
+int bno_err_transient(int cls) {
+   return(cls == BNO_E_NACK || cls == BNO_E_TIMEOUT || cls == BNO_E_BUS);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_retry_set() - retry policy for transient bus errors: max *
+ * retries after the first attempt, the first backoff in us and *
+ * its cap. The worst case delay of one transaction is bounded  *
+ * by max * delay_max_us plus the attempts themselves.          *
+ * ------------------------------------------------------------ */
+int bno_retry_set(bno055_t *bno, int max, long delay_us, long delay_max_us) {
+   if(max < 0 || max > 100 || delay_us < 0 || delay_max_us < delay_us || delay_max_us > 1000000) {
+      BNO_ERROR("Error: invalid retry policy %d retries, %ld..%ld us.\n", max, delay_us, delay_max_us);
+      errno = EINVAL;
+      return(-1);
+   }
+   bno->retry.max = max;
+   bno->retry.delay_us = delay_us;
+   bno->retry.delay_max_us = delay_max_us;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bus_once() - one attempt of a bus transaction: BNO_TR_READ   *
+ * and BNO_TR_WRITE of xfer[0], or BNO_TR_MULTI of all blocks.  *
+ * ------------------------------------------------------------ */
+static int bus_once(bno055_t *bno, int op, struct bnoxfer *xfer, int count) {
+   int i, res = 0;
+   switch(op) {
+      case BNO_TR_READ:
+         return bno->bus.read_regs(&bno->bus, xfer->reg, xfer->buf, xfer->len);
+      case BNO_TR_WRITE:
+         return bno->bus.write_regs(&bno->bus, xfer->reg, xfer->buf, xfer->len);
+      default:
+         if(bno->bus.read_multi != NULL) return bno->bus.read_multi(&bno->bus, xfer, count);
+         for(i = 0; i < count && res == 0; i++)
+            res = bno->bus.read_regs(&bno->bus, xfer[i].reg, xfer[i].buf, xfer[i].len);
+         return(res);
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * bus_xfer() - run a bus transaction, repeating it after a     *
+ * transient failure as bno->retry allows. t0 is the start of   *
+ * the last attempt. Failures are counted in bno->errs, errno   *
+ * is left as the last attempt set it.                          *
+ * ------------------------------------------------------------ */
+static int bus_xfer(bno055_t *bno, int op, struct bnoxfer *xfer, int count, struct timespec *t0) {
+   static const char *ops[] = { "read", "write", "read" };
+   long delay = bno->retry.delay_us;
+   int attempt, err, i;
+
+   for(attempt = 0; ; attempt++) {
+      clock_gettime(CLOCK_MONOTONIC_RAW, t0);
+      int res = bus_once(bno, op, xfer, count);
+      if(bno->trace != NULL) {
+         int len = 0;
+         for(i = 0; i < count; i++) len += xfer[i].len;
+         bno_trace_rec(bno, op, xfer->reg, len, count, res, t0);
+      }
+      if(res == 0) {
+         if(attempt > 0) bno->errs.recovered++;
+         return(0);
+      }
+
+      err = errno;
+      int cls = bno_errclass(err);
+      bno->errs.count[cls]++;
+      bno->errs.last = cls;
+      bno->errs.last_errno = err;
+      if(!bno_err_transient(cls) || attempt >= bno->retry.max) break;
+
+      bno->errs.retries++;
+      BNO_DEBUG(bno->verbose, "Debug: %s %s of register 0x%02X failed (%s), retry %d in %ld us\n",
+                bno->bus.name, ops[op % 3], xfer->reg, strerror(err), attempt + 1, delay);
+      if(delay > 0) {
+         struct timespec ts = { delay / 1000000, (delay % 1000000) * 1000 };
+         nanosleep(&ts, NULL);
+      }
+      delay *= 2;
+      if(delay > bno->retry.delay_max_us) delay = bno->retry.delay_max_us;
    }
+
+   bno->errs.failed++;
+   if(bno->errs.last != BNO_E_NODATA)
+      BNO_ERROR("Error: %s %s of register 0x%02X failed after %d attempts, %s\n",
+                bno->bus.name, ops[op % 3], xfer->reg, attempt + 1, strerror(err));
+   errno = err;
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_read_multi() - reads several register blocks. Backends   *
+ * with a batch operation fetch them in a single transaction,   *
+ * the others get one read_regs() call per block.               *
+ * ------------------------------------------------------------ */
+int bno_read_multi(bno055_t *bno, struct bnoxfer *xfer, int count) {
+   struct timespec t0;
+   int i;
+   if(bus_xfer(bno, BNO_TR_MULTI, xfer, count, &t0) != 0) return(-1);
+   xfer_stamp(bno, &t0);
+   for(i = 0; i < count; i++) shadow_fill(bno, xfer[i].reg, xfer[i].buf, xfer[i].len);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_read_regs() - reads len bytes starting at register reg,  *
+ * using a single combined write+read bus transaction. Its time *
+ * is kept in bno->xfer, the get_ functions copy it to the data.*
+ * ------------------------------------------------------------ */
+int bno_read_regs(bno055_t *bno, unsigned char reg, void *buf, int len) {
+   struct timespec t0;
+   struct bnoxfer xfer = { reg, len, buf };
+   BNO_DEBUG(bno->verbose, "Debug: I2C read %d bytes starting at register 0x%02X\n", len, reg);
+   if(bus_xfer(bno, BNO_TR_READ, &xfer, 1, &t0) != 0) return(-1);
+   xfer_stamp(bno, &t0);
+   shadow_fill(bno, reg, buf, len);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_write_regs() - writes len bytes starting at register reg *
+ * ------------------------------------------------------------ */
+int bno_write_regs(bno055_t *bno, unsigned char reg, const void *buf, int len) {
+   struct timespec t0;
+   struct bnoxfer xfer = { reg, len, (void *) buf };
+   if(bus_xfer(bno, BNO_TR_WRITE, &xfer, 1, &t0) != 0) return(-1);
+   shadow_write(bno, reg, buf, len);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_write_reg() - writes a single byte value to register reg *
+ * ------------------------------------------------------------ */
+int bno_write_reg(bno055_t *bno, unsigned char reg, unsigned char val) {
+   return bno_write_regs(bno, reg, &val, 1);
 }
 
 /* --------------------------------------------------------------- *
- * bno_dump() dumps the register map data.                         *
+ * bno_dump_page() reads the 8 rows of 16 registers of the current *
+ * page in one batched I2C_RDWR transaction and prints them.       *
  * --------------------------------------------------------------- */
-int bno_dump() {
+static int bno_dump_page(bno055_t *bno) {
+   unsigned char data[8][16] = {{0}};
+   struct bnoxfer xfer[8];
    int count = 0;
 
-   printf("------------------------------------------------------\n");
-   printf("BNO055 page-0:\n");
-   printf("------------------------------------------------------\n");
-   printf(" reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
-   printf("------------------------------------------------------\n");
    while(count < 8) {
-      char reg = count;
-      if(write(i2cfd, &reg, 1) != 1) {
-         printf("Error: I2C write failure for register 0x%02X\n", reg);
-         exit(-1);
-      }
+      xfer[count].reg = count * 16;
+      xfer[count].len = 16;
+      xfer[count].buf = data[count];
+      count++;
+   }
+   if(bno_read_multi(bno, xfer, 8) != 0) return(-1);
 
-      char data[16] = {0};
-      if(read(i2cfd, &data, 16) != 16) {
-         printf("Error: I2C read failure for register 0x%02X\n", reg);
-         exit(-1);
-       
-      }
+   count = 0;
+   while(count < 8) {
+      unsigned char *d = data[count];
       printf("[0x%02X] %02X %02X %02X %02X %02X %02X %02X %02X",
-             (reg*16), data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
+             (count*16), d[0], d[1], d[2], d[3], d[4], d[5], d[6], d[7]);
       printf(" %02X %02X %02X %02X %02X %02X %02X %02X\n",
-             data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
+             d[8], d[9], d[10], d[11], d[12], d[13], d[14], d[15]);
       count++;
    }
+   return(0);
+}
 
-   set_page1();
+/* --------------------------------------------------------------- *
+ * bno_dump() dumps the register map data.                         *
+ * --------------------------------------------------------------- */
+int bno_dump(bno055_t *bno) {
+   printf("------------------------------------------------------\n");
+   printf("BNO055 page-0:\n");
+   printf("------------------------------------------------------\n");
+   printf(" reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
+   printf("------------------------------------------------------\n");
+   if(bno_dump_page(bno) != 0) return(-1);
+
+   if(set_page1(bno) != 0) return(-1);
    usleep(50 * 1000);
-   count = 0;
    printf("------------------------------------------------------\n");
    printf("BNO055 page-1:\n");
    printf("------------------------------------------------------\n");
    printf(" reg    0  1  2  3  4  5  6  7  8  9  A  B  C  D  E  F\n");
    printf("------------------------------------------------------\n");
-   while(count < 8) {
-      char reg = count;
-      if(write(i2cfd, &reg, 1) != 1) {
-         printf("Error: I2C write failure for register 0x%02X\n", reg);
-         exit(-1);
-      }
-
-      char data[16] = {0};
-      if(read(i2cfd, &data, 16) != 16) {
-         printf("Error: I2C read failure for register 0x%02X\n", reg);
-         exit(-1);
-       
-      }
-      printf("[0x%02X] %02X %02X %02X %02X %02X %02X %02X %02X",
-             (reg*16), data[0], data[1], data[2], data[3], data[4], data[5], data[6], data[7]);
-      printf(" %02X %02X %02X %02X %02X %02X %02X %02X\n",
-             data[8], data[9], data[10], data[11], data[12], data[13], data[14], data[15]);
-      count++;
-   }
+   int res = bno_dump_page(bno);
 
-   set_page0();
+   int err = errno;
+   if(set_page0(bno) != 0) return(-1);
+   errno = err;
    usleep(50 * 1000);
-   exit(0);
+   return(res);
 }
 
 /* --------------------------------------------------------------- *
  * bno_reset() resets the sensor. It will come up in CONFIG mode.  *
  * --------------------------------------------------------------- */
-int bno_reset() {
-   char data[2];
-   data[0] = BNO055_SYS_TRIGGER_ADDR;
-   data[1] = 0x20;
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      exit(-1);
-   }
-   if(verbose == 1) printf("Debug: BNO055 Sensor Reset complete\n");
+int bno_reset(bno055_t *bno) {
+   if(bno_write_reg(bno, BNO055_SYS_TRIGGER_ADDR, 0x20) != 0) return(-1);
+   BNO_DEBUG(bno->verbose, "Debug: BNO055 Sensor Reset complete\n");
    
    /* ------------------------------------------------------------ *
     * After a reset, the sensor needs at leat 650ms to boot up.    *
     * ------------------------------------------------------------ */
    usleep(650 * 1000);
-   exit(0);
+   return(0);
 }
 
 /* ------------------------------------------------------------ *
- * get_calstatus() gets the calibration state from the sensor. *
- * Calibration status has 4 values, encoded as 2bit in reg 0x35 *
+ * restore_mode() - return to oldmode after a failed transfer,  *
+ * keeping the errno of the failure for the caller              *
  * ------------------------------------------------------------ */
-int get_calstatus(struct bnocal *bno_ptr) {
-   char reg = BNO055_CALIB_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
+static void restore_mode(bno055_t *bno, opmode_t oldmode) {
+   int err = errno;
+   set_mode(bno, oldmode);
+   errno = err;
+}
 
-   char data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register 0x%02X\n", reg);
+/* ------------------------------------------------------------ *
+ * enter_config() - switch to CONFIG for calibration register   *
+ * access, the mode to return to goes to oldmode. -1 if the     *
+ * mode is unknown or the switch failed, the sensor is then     *
+ * back in its old mode as far as that is possible.             *
+ * ------------------------------------------------------------ */
+static int enter_config(bno055_t *bno, opmode_t *oldmode) {
+   int mode = get_mode(bno);
+   if(mode < 0) return(-1);
+   *oldmode = mode;
+   if(set_mode(bno, config) != 0) {
+      restore_mode(bno, mode);
       return(-1);
    }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * debug_calset() - print the 34 calibration bytes as one line  *
+ * ------------------------------------------------------------ */
+static void debug_calset(bno055_t *bno, const unsigned char *data) {
+#ifndef BNO_NO_DEBUG
+   if(bno->verbose != 1) return;
+   char line[CALIB_BYTECOUNT * 3 + 1];
+   int i;
+   for(i = 0; i < CALIB_BYTECOUNT; i++) sprintf(&line[3 * i], " %02X", data[i]);
+   bno_log(BNO_LOG_DEBUG, "Debug: Calibrationset:%s\n", line);
+#endif
+}
+
+/* ------------------------------------------------------------ *
+ * get_calstatus() gets the calibration state from the sensor. *
+ * Calibration status has 4 values, encoded as 2bit in reg 0x35 *
+ * ------------------------------------------------------------ */
+int get_calstatus(bno055_t *bno, struct bnocal *bno_ptr) {
+   unsigned char data = 0;
+   if(bno_read_regs(bno, BNO055_CALIB_STAT_ADDR, &data, 1) != 0) return(-1);
 
    bno_ptr->scal_st = (data & 0b11000000) >> 6; // system calibration status
-   if(verbose == 1) printf("Debug: sensor system calibration: [%d]\n", bno_ptr->scal_st);
+   BNO_DEBUG(bno->verbose, "Debug: sensor system calibration: [%d]\n", bno_ptr->scal_st);
    bno_ptr->gcal_st = (data & 0b00110000) >> 4; // gyro calibration
-   if(verbose == 1) printf("Debug:     gyroscope calibration: [%d]\n", bno_ptr->gcal_st);
+   BNO_DEBUG(bno->verbose, "Debug:     gyroscope calibration: [%d]\n", bno_ptr->gcal_st);
    bno_ptr->acal_st = (data & 0b00001100) >> 2; // accel calibration status
-   if(verbose == 1) printf("Debug: accelerometer calibration: [%d]\n", bno_ptr->acal_st);
+   BNO_DEBUG(bno->verbose, "Debug: accelerometer calibration: [%d]\n", bno_ptr->acal_st);
    bno_ptr->mcal_st = (data & 0b00000011);      // magneto calibration status
-   if(verbose == 1) printf("Debug:  magnetometer calibration: [%d]\n", bno_ptr->mcal_st);
+   BNO_DEBUG(bno->verbose, "Debug:  magnetometer calibration: [%d]\n", bno_ptr->mcal_st);
    return(0);
 }
 
@@ -165,41 +668,25 @@ int get_calstatus(struct bnocal *bno_ptr) {
  * Calibration offset is stored in 3x6 (18) registers 0x55~0x66 *
  * plus 4 registers 0x67~0x6A accelerometer/magnetometer radius *
  * ------------------------------------------------------------ */
-int get_caloffset(struct bnocal *bno_ptr) {
+int get_caloffset(bno055_t *bno, struct bnocal *bno_ptr) {
    /* --------------------------------------------------------- *
     * Registers may not update in fusion mode, switch to CONFIG *
     * --------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
+   opmode_t oldmode;
+   if(enter_config(bno, &oldmode) != 0) return(-1);
 
-   char reg = ACC_OFFSET_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   unsigned char data[CALIB_BYTECOUNT] = {0};
+   if(bno_read_regs(bno, ACC_OFFSET_X_LSB_ADDR, data, CALIB_BYTECOUNT) != 0) {
+      restore_mode(bno, oldmode);
       return(-1);
    }
-
-   if(verbose == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n", CALIB_BYTECOUNT, reg);
-
-   char data[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) {
-      int i = 0;
-      printf("Debug: Calibrationset:");
-      while(i<CALIB_BYTECOUNT) {
-         printf(" %02X", data[i]);
-         i++;
-      }
-      printf("\n");
-   }
+   debug_calset(bno, data);
 
    /* ------------------------------------------------------------ *
     * assigning accelerometer X-Y-Z offset, range per G-range      *
     * 16G = +/-16000, 8G = +/-8000, 4G = +/-4000, 2G = +/-2000     *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug: accelerometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   BNO_DEBUG(bno->verbose, "Debug: accelerometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
 		           ((int16_t)data[1] << 8) | data[0],
                            ((int16_t)data[3] << 8) | data[2],
                            ((int16_t)data[5] << 8) | data[4]);
@@ -210,7 +697,7 @@ int get_caloffset(struct bnocal *bno_ptr) {
    /* ------------------------------------------------------------ *
     * assigning magnetometer X-Y-Z offset, offset range is +/-6400 *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:  magnetometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   BNO_DEBUG(bno->verbose, "Debug:  magnetometer offset: [%d] [%d] [%d] (X-Y-Z)\n",
                            ((int16_t)data[7] << 8) | data[6],
                            ((int16_t)data[9] << 8) | data[8],
                            ((int16_t)data[11] << 8) | data[10]);
@@ -222,7 +709,7 @@ int get_caloffset(struct bnocal *bno_ptr) {
     * assigning gyroscope X-Y-Z offset, range depends on dps value *
     * 2000 = +/-32000, 1000 = +/-16000, 500 = +/-8000, etc         *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:     gyroscope offset: [%d] [%d] [%d] (X-Y-Z)\n",
+   BNO_DEBUG(bno->verbose, "Debug:     gyroscope offset: [%d] [%d] [%d] (X-Y-Z)\n",
                            ((int16_t)data[13] << 8) | data[12],
                            ((int16_t)data[15] << 8) | data[14],
                            ((int16_t)data[17] << 8) | data[16]);
@@ -233,127 +720,108 @@ int get_caloffset(struct bnocal *bno_ptr) {
    /* ------------------------------------------------------------ *
     * assigning accelerometer radius, range is +/-1000             *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug: accelerometer radius: [%d] (+/-1000)\n",
+   BNO_DEBUG(bno->verbose, "Debug: accelerometer radius: [%d] (+/-1000)\n",
                            ((int16_t)data[19] << 8) | data[18]);
    bno_ptr->acc_rad = ((int16_t)data[19] << 8) | data[18];
 
    /* ------------------------------------------------------------ *
     * assigning magnetometer radius, range is +/-960               *
     * ------------------------------------------------------------ */
-   if(verbose == 1) printf("Debug:  magnetometer radius: [%d] (+/- 960)\n",
+   BNO_DEBUG(bno->verbose, "Debug:  magnetometer radius: [%d] (+/- 960)\n",
                            ((int16_t)data[21] << 8) | data[20]);
    bno_ptr->mag_rad = ((int16_t)data[21] << 8) | data[20];
-   set_mode(oldmode);
-   return(0);
+   return(set_mode(bno, oldmode));
 }
 
 /* ------------------------------------------------------------ *
- * save_cal() - writes calibration data to file for reuse       *
+ * get_calset() - read the CALIB_BYTECOUNT bytes calibration    *
+ * set that save_cal() stores, into data. Switches to CONFIG    *
+ * for the read, the data is only visible in non-fusion mode.   *
  * ------------------------------------------------------------ */
-int save_cal(char *file) {
+int get_calset(bno055_t *bno, unsigned char *data) {
    /* --------------------------------------------------------- *
     * Read 34 bytes calibration data from registers 0x43~66,    *
     * plus 4 reg 0x67~6A with accelerometer/magnetometer radius *
-    * switch to CONFIG, data is only visible in non-fusion mode *
     * --------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
-   int i = 0;
-   //char reg = ACC_OFFSET_X_LSB_ADDR;
-   char reg = BNO055_SIC_MATRIX_0_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+   opmode_t oldmode;
+   if(enter_config(bno, &oldmode) != 0) return(-1);
+   if(bno_read_regs(bno, BNO055_SIC_MATRIX_0_LSB_ADDR, data, CALIB_BYTECOUNT) != 0) {
+      restore_mode(bno, oldmode);
       return(-1);
    }
+   return(set_mode(bno, oldmode));
+}
 
-   if(verbose == 1) printf("Debug: I2C read %d bytes starting at register 0x%02X\n",
-                           CALIB_BYTECOUNT, reg);
-
-   char data[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, data, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) {
-      printf("Debug: Calibrationset:");
-      while(i<CALIB_BYTECOUNT) {
-         printf(" %02X", data[i]);
-         i++;
-      }
-      printf("\n");
-   }
+/* ------------------------------------------------------------ *
+ * save_cal() - writes calibration data to file for reuse       *
+ * ------------------------------------------------------------ */
+int save_cal(bno055_t *bno, char *file) {
+   unsigned char data[CALIB_BYTECOUNT] = {0};
+   if(get_calset(bno, data) != 0) return(-1);
+   debug_calset(bno, data);
 
    /* -------------------------------------------------------- *
     *  Open the calibration data file for writing.             *
     * -------------------------------------------------------- */
    FILE *calib;
    if(! (calib=fopen(file, "w"))) {
-      printf("Error: Can't open %s for writing.\n", file);
-      exit(-1);
+      BNO_ERROR("Error: Can't open %s for writing, %s\n", file, strerror(errno));
+      return(-1);
    }
-   if(verbose == 1) printf("Debug:  Write to file: [%s]\n", file);
+   BNO_DEBUG(bno->verbose, "Debug:  Write to file: [%s]\n", file);
 
    /* -------------------------------------------------------- *
     * write the bytes in data[] out                            *
     * -------------------------------------------------------- */
    int outbytes = fwrite(data, 1, CALIB_BYTECOUNT, calib);
    fclose(calib);
-   if(verbose == 1) printf("Debug:  Bytes to file: [%d]\n", outbytes);
+   BNO_DEBUG(bno->verbose, "Debug:  Bytes to file: [%d]\n", outbytes);
    if(outbytes != CALIB_BYTECOUNT) {
-      printf("Error: %d/%d bytes written to file.\n", outbytes, CALIB_BYTECOUNT);
+      BNO_ERROR("Error: %d/%d bytes written to file.\n", outbytes, CALIB_BYTECOUNT);
       return(-1);
    }
-   set_mode(oldmode);
    return(0);
 }
 
 /* ------------------------------------------------------------ *
  * load_cal() load previously saved calibration data from file  *
  * ------------------------------------------------------------ */
-int load_cal(char *file) {
+int load_cal(bno055_t *bno, char *file) {
    /* -------------------------------------------------------- *
     *  Open the calibration data file for reading.             *
     * -------------------------------------------------------- */
    FILE *calib;
    if(! (calib=fopen(file, "r"))) {
-      printf("Error: Can't open %s for reading.\n", file);
-      exit(-1);
+      BNO_ERROR("Error: Can't open %s for reading, %s\n", file, strerror(errno));
+      return(-1);
    }
-   if(verbose == 1) printf("Debug: Load from file: [%s]\n", file);
+   BNO_DEBUG(bno->verbose, "Debug: Load from file: [%s]\n", file);
 
    /* -------------------------------------------------------- *
     * Read 34 bytes from file into data[], starting at data[1] *
     * -------------------------------------------------------- */
-   char data[CALIB_BYTECOUNT+1] = {0};
+   unsigned char data[CALIB_BYTECOUNT+1] = {0};
    //data[0] = ACC_OFFSET_X_LSB_ADDR;
    data[0] = BNO055_SIC_MATRIX_0_LSB_ADDR;
    int inbytes = fread(&data[1], 1, CALIB_BYTECOUNT, calib);
    fclose(calib);
 
    if(inbytes != CALIB_BYTECOUNT) {
-      printf("Error: %d/%d bytes read to file.\n", inbytes, CALIB_BYTECOUNT);
+      BNO_ERROR("Error: %d/%d bytes read to file.\n", inbytes, CALIB_BYTECOUNT);
       return(-1);
    }
-   if(verbose == 1) {
-      printf("Debug: Calibrationset:");
-      int i = 1;
-      while(i<CALIB_BYTECOUNT+1) {
-         printf(" %02X", data[i]);
-         i++;
-      }
-      printf("\n");
-   }
+   debug_calset(bno, &data[1]);
 
    /* -------------------------------------------------------- *
     * Write 34 bytes from file into sensor registers from 0x43 *
     * We need to switch in and out of CONFIG mode if needed... *
     * -------------------------------------------------------- */
-   opmode_t oldmode = get_mode();
-   set_mode(config);
+   opmode_t oldmode;
+   if(enter_config(bno, &oldmode) != 0) return(-1);
    usleep(50 * 1000);
 
-   if(write(i2cfd, data, (CALIB_BYTECOUNT+1)) != (CALIB_BYTECOUNT+1)) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
+   if(bno_write_regs(bno, data[0], &data[1], CALIB_BYTECOUNT) != 0) {
+      restore_mode(bno, oldmode);
       return(-1);
    }
 
@@ -362,29 +830,26 @@ int load_cal(char *file) {
     * -------------------------------------------------------- */
    //char reg = ACC_OFFSET_X_LSB_ADDR;
    char reg = BNO055_SIC_MATRIX_0_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   char newdata[CALIB_BYTECOUNT] = {0};
-   if(read(i2cfd, newdata, CALIB_BYTECOUNT) != CALIB_BYTECOUNT) {
-      printf("Error: I2C calibration data read from 0x%02X\n", reg);
+   unsigned char newdata[CALIB_BYTECOUNT] = {0};
+   if(bno_read_regs(bno, reg, newdata, CALIB_BYTECOUNT) != 0) {
+      restore_mode(bno, oldmode);
       return(-1);
    }
 
-   if(verbose == 1) printf("Debug: Registerupdate:");
-   int i = 0;
+   debug_calset(bno, newdata);
+   int i = 0, bad = 0;
    while(i<CALIB_BYTECOUNT) {
       if(data[i+1] != newdata[i]) {
-         printf("\nError: Calibration load failure %02X register 0x%02X\n", newdata[i], reg+i);
-         //exit(-1);
+         BNO_ERROR("Error: Calibration load failure %02X register 0x%02X\n", newdata[i], reg+i);
+         bad++;
       }
-      if(verbose == 1) printf(" %02X", newdata[i]);
       i++;
    }
-   if(verbose == 1) printf("\n");
-   set_mode(oldmode);
+   if(set_mode(bno, oldmode) != 0) return(-1);
+   if(bad > 0) {
+      errno = EIO;
+      return(-1);
+   }
 
    /* -------------------------------------------------------- *
     * 650 ms delay are only needed if -l and -t are both used  *
@@ -431,436 +896,293 @@ void print_unit(int unit_sel) {
  * get_inf() queries the BNO055 and write the info data into    *
  * the global struct bnoinf defined in getbno055.h              *
  * ------------------------------------------------------------ */
-int get_inf(struct bnoinf *bno_ptr) {
-   char reg = 0x00;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
+int get_inf(bno055_t *bno, struct bnoinf *bno_ptr) {
+   /* --------------------------------------------------------- *
+    * Two register blocks, fetched together in one I2C_RDWR:   *
+    * 0x00-0x06 IDs and revisions, 0x34-0x42 status and config  *
+    * --------------------------------------------------------- */
+   unsigned char data[7] = {0};
+   unsigned char stat[BNO055_AXIS_MAP_SIGN_ADDR - BNO055_TEMP_ADDR + 1] = {0};
+   struct bnoxfer xfer[2] = {
+      { BNO055_CHIP_ID_ADDR, sizeof(data), data },
+      { BNO055_TEMP_ADDR,    sizeof(stat), stat }
+   };
+   if(bno_read_multi(bno, xfer, 2) != 0) return(-1);
+#define STAT(r) stat[(r) - BNO055_TEMP_ADDR]
 
-   char data[7] = {0};
-   if(read(i2cfd, data, 7) != 7) {
-      printf("Error: I2C read failure for register data 0x00-0x06\n");
-      return(-1);
-   }
    /* --------------------------------------------------------- *
     * 1-byte chip ID in register 0x00, default: 0xA0            *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor CHIP ID: [0x%02X]\n", data[0]);
+   BNO_DEBUG(bno->verbose, "Debug: Sensor CHIP ID: [0x%02X]\n", data[0]);
    bno_ptr->chip_id = data[0];
 
    /* --------------------------------------------------------- *
     * 1-byte Accelerometer ID in register 0x01, default: 0xFB   *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  ACC ID: [0x%02X]\n", data[1]);
+   BNO_DEBUG(bno->verbose, "Debug: Sensor  ACC ID: [0x%02X]\n", data[1]);
    bno_ptr->acc_id = data[1];
 
    /* --------------------------------------------------------- *
     * 1-byte Magnetometer ID in register 0x02, default 0x32     *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  MAG ID: [0x%02X]\n", data[2]);
+   BNO_DEBUG(bno->verbose, "Debug: Sensor  MAG ID: [0x%02X]\n", data[2]);
    bno_ptr->mag_id = data[2];
 
    /* --------------------------------------------------------- *
     * 1-byte Gyroscope ID in register 0x03, default: 0x0F       *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Sensor  GYR ID: [0x%02X]\n", data[3]);
+   BNO_DEBUG(bno->verbose, "Debug: Sensor  GYR ID: [0x%02X]\n", data[3]);
    bno_ptr->gyr_id = data[3];
 
    /* --------------------------------------------------------- *
     * 1-byte SW Revsion ID LSB in register 0x04, default: 0x08  *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: SW  Rev-ID LSB: [0x%02X]\n", data[4]);
+   BNO_DEBUG(bno->verbose, "Debug: SW  Rev-ID LSB: [0x%02X]\n", data[4]);
    bno_ptr->sw_lsb = data[4];
 
    /* --------------------------------------------------------- *
     * 1-byte SW Revision ID MSB in register 0x05, default: 0x03 *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: SW  Rev-ID MSB: [0x%02X]\n", data[5]);
+   BNO_DEBUG(bno->verbose, "Debug: SW  Rev-ID MSB: [0x%02X]\n", data[5]);
    bno_ptr->sw_msb = data[5];
 
    /* --------------------------------------------------------- *
     * 1-byte BootLoader Revision ID register 0x06, no default   *
     * --------------------------------------------------------- */
-   if(verbose == 1) printf("Debug: Bootloader Ver: [0x%02X]\n", data[6]);
+   BNO_DEBUG(bno->verbose, "Debug: Bootloader Ver: [0x%02X]\n", data[6]);
    bno_ptr->bl_rev = data[6];
 
    /* --------------------------------------------------------- *
-    * Read the operations mode with get_mode(), default: 0x0    *
+    * Operations mode in register 0x3D, lowest 4 bit, default 0 *
     * --------------------------------------------------------- */
-   bno_ptr->opr_mode = get_mode();
+   BNO_DEBUG(bno->verbose, "Debug: Operation Mode: [0x%02X]\n", STAT(BNO055_OPR_MODE_ADDR) & 0x0F);
+   bno_ptr->opr_mode = STAT(BNO055_OPR_MODE_ADDR) & 0x0F;
 
    /* --------------------------------------------------------- *
-    * Read the power mode with get_power(), default: 0x0        *
+    * Power mode in register 0x3E, lowest 2 bit, default: 0x0   *
     * --------------------------------------------------------- */
-   bno_ptr->pwr_mode = get_power();
+   BNO_DEBUG(bno->verbose, "Debug:     Power Mode: [0x%02X] 2bit [0x%02X]\n",
+                           STAT(BNO055_PWR_MODE_ADDR), STAT(BNO055_PWR_MODE_ADDR) & 0x03);
+   bno_ptr->pwr_mode = STAT(BNO055_PWR_MODE_ADDR) & 0x03;
 
    /* --------------------------------------------------------- *
-    * Read the axis remap config get_remap('c'), default: 0x24  *
+    * Axis remap config in register 0x41, default: 0x24         *
     * --------------------------------------------------------- */
-   bno_ptr->axr_conf = get_remap('c');
+   BNO_DEBUG(bno->verbose, "Debug: Axis Remap 'c': [0x%02X]\n", STAT(BNO055_AXIS_MAP_CONFIG_ADDR));
+   bno_ptr->axr_conf = STAT(BNO055_AXIS_MAP_CONFIG_ADDR);
 
    /* --------------------------------------------------------- *
-    * Read the axis remap sign get_remap('s'), default: 0x00    *
+    * Axis remap sign in register 0x42, default: 0x00           *
     * --------------------------------------------------------- */
-   bno_ptr->axr_sign = get_remap('s');
+   BNO_DEBUG(bno->verbose, "Debug: Axis Remap 's': [0x%02X]\n", STAT(BNO055_AXIS_MAP_SIGN_ADDR));
+   bno_ptr->axr_sign = STAT(BNO055_AXIS_MAP_SIGN_ADDR);
 
    /* --------------------------------------------------------- *
-    * Read 1-byte system status from register 0x39, no default  *
+    * 1-byte system status from register 0x39, no default       *
     * --------------------------------------------------------- */
-   reg = BNO055_SYS_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) printf("Debug:  System Status: [0x%02X]\n", data[0]);
-   bno_ptr->sys_stat = data[0];
+   BNO_DEBUG(bno->verbose, "Debug:  System Status: [0x%02X]\n", STAT(BNO055_SYS_STAT_ADDR));
+   bno_ptr->sys_stat = STAT(BNO055_SYS_STAT_ADDR);
 
    /* --------------------------------------------------------- *
-    * Read 1-byte Self Test Result register 0x36, 0x0F=pass     *
+    * 1-byte Self Test Result register 0x36, 0x0F=pass          *
     * --------------------------------------------------------- */
-   reg = BNO055_SELFTSTRES_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) printf("Debug: Self-Test Mode: [0x%02X] 4bit [0x%02X]\n", data[0], data[0] & 0x0F);
-   bno_ptr->selftest = data[0] & 0x0F; // only get the lowest 4 bits
+   BNO_DEBUG(bno->verbose, "Debug: Self-Test Mode: [0x%02X] 4bit [0x%02X]\n",
+                           STAT(BNO055_SELFTSTRES_ADDR), STAT(BNO055_SELFTSTRES_ADDR) & 0x0F);
+   bno_ptr->selftest = STAT(BNO055_SELFTSTRES_ADDR) & 0x0F; // only get the lowest 4 bits
 
    /* --------------------------------------------------------- *
-    * Read 1-byte System Error from register 0x3A, 0=OK         *
+    * 1-byte System Error from register 0x3A, 0=OK              *
     * --------------------------------------------------------- */
-   reg = BNO055_SYS_ERR_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) printf("Debug: Internal Error: [0x%02X]\n", data[0]);
-   bno_ptr->sys_err = data[0];
+   BNO_DEBUG(bno->verbose, "Debug: Internal Error: [0x%02X]\n", STAT(BNO055_SYS_ERR_ADDR));
+   bno_ptr->sys_err = STAT(BNO055_SYS_ERR_ADDR);
 
    /* --------------------------------------------------------- *
-    * Read 1-byte Unit definition from register 0x3B, 0=OK      *
+    * 1-byte Unit definition from register 0x3B, 0=OK           *
     * --------------------------------------------------------- */
-   reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) printf("Debug: UnitDefinition: [0x%02X]\n", data[0]);
-   bno_ptr->unitsel = data[0];
+   BNO_DEBUG(bno->verbose, "Debug: UnitDefinition: [0x%02X]\n", STAT(BNO055_UNIT_SEL_ADDR));
+   bno_ptr->unitsel = STAT(BNO055_UNIT_SEL_ADDR);
 
    /* --------------------------------------------------------- *
     * Extract the temperature unit from the unit selection data *
     * --------------------------------------------------------- */
    char t_unit;
-   if((data[0] >> 4) & 0x01) t_unit = 'F';
+   if((STAT(BNO055_UNIT_SEL_ADDR) >> 4) & 0x01) t_unit = 'F';
    else  t_unit = 'C';
 
    /* --------------------------------------------------------- *
-    * Read sensor temperature from register 0x34, no default    *
+    * Sensor temperature from register 0x34, no default         *
     * --------------------------------------------------------- */
-   reg = BNO055_TEMP_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   data[0] = 0;
-   if(read(i2cfd, data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-   if(verbose == 1) printf("Debug:    Temperature: [0x%02X] [%d°%c]\n", data[0], data[0], t_unit);
-   bno_ptr->temp_val = data[0];
+   BNO_DEBUG(bno->verbose, "Debug:    Temperature: [0x%02X] [%d°%c]\n",
+                           STAT(BNO055_TEMP_ADDR), (signed char) STAT(BNO055_TEMP_ADDR), t_unit);
+   bno_ptr->temp_val = STAT(BNO055_TEMP_ADDR);
+#undef STAT
 
    return(0);
 }
 /* ------------------------------------------------------------ *
- *  get_acc() - read accelerometer data into the global struct  *
+ * le16() - signed 16 bit value from a LSB/MSB register pair    *
  * ------------------------------------------------------------ */
-int get_acc(struct bnoacc *bnod_ptr) {
-   char reg = BNO055_ACC_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Accelerometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->adata_x = (double) buf;
-
-   buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Accelerometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->adata_y = (double) buf;
-
-   buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Accelerometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->adata_z = (double) buf;
-   return(0);
+static inline int16_t le16(const unsigned char *data) {
+   return (int16_t)((data[1] << 8) | data[0]);
 }
 
 /* ------------------------------------------------------------ *
- *  get_mag() - read magnetometer data into the global struct   *
- *  Convert magnetometer data in microTesla. 1 microTesla = 16  *
+ * Data vector table expanded from BNO_VECTORS, in BNO_F_ order *
  * ------------------------------------------------------------ */
-int get_mag(struct bnomag *bnod_ptr) {
-   char reg = BNO055_MAG_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
+#define VEC_ENUM(f, F, ...) VEC_##f,
+enum { BNO_VECTORS(VEC_ENUM) VEC_COUNT };
+
+#define VEC_DESC(f, F, reg, n, div0, div1, name, axis, ...) \
+   { reg, n, { div0, div1 }, name, axis },
+static const struct {
+   unsigned char reg;        // first data register
+   unsigned char n;          // values, 3 or 4
+   double div[2];            // LSB per unit by UNIT_SEL bit-0
+   const char *name;
+   const char *axis;
+} vec_desc[] = { BNO_VECTORS(VEC_DESC) };
+
+#define VEC_CHECK(f, F, reg, ...) \
+   _Static_assert(BNO_F_##F == 1 << VEC_##f, "BNO_F_" #F " is not in table order"); \
+   _Static_assert(BNO_CH_##F == ((reg) - SNAPSHOT_START) / 2, "BNO_CH_" #F " does not match its register");
+BNO_VECTORS(VEC_CHECK)
 
-   char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
+/* ------------------------------------------------------------ *
+ * bno_raw_div() - LSB per unit of data channel ch: the value   *
+ * is raw / div. unit_sel is register 0x3B, its bit-0 selects   *
+ * 1 m/s2 = 100 LSB or 1 mg = 1 LSB for linear acc and gravity. *
+ * ------------------------------------------------------------ */
+double bno_raw_div(int ch, unsigned char unit_sel) {
+   int g;
+   for(g = 0; g < VEC_COUNT; g++) {
+      int first = (vec_desc[g].reg - SNAPSHOT_START) / 2;
+      if(ch >= first && ch < first + vec_desc[g].n) return(vec_desc[g].div[unit_sel & 0x01]);
    }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->mdata_x = (double) buf / 1.6;
-
-   buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->mdata_y = (double) buf / 1.6;
-
-   buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Magnetometer Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->mdata_z = (double) buf / 1.6;
-   return(0);
+   return(1.0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_gyr() - read gyroscope data into the global struct      *
+ * vec_read() - burst read of vector g as int16, inlined with a *
+ * constant g into each get_ function, which folds the table    *
+ * lookups and drops the UNIT_SEL read for fixed scales.        *
  * ------------------------------------------------------------ */
-int get_gyr(struct bnogyr *bnod_ptr) {
-   char reg = BNO055_GYRO_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
+static inline int vec_read(bno055_t *bno, int g, struct bnoraw *raw_ptr) {
+   int unit_sel = 0;
+   if(vec_desc[g].div[0] != vec_desc[g].div[1]) {
+      unit_sel = bno_shadow_get(bno, 0, BNO055_UNIT_SEL_ADDR);
+      if(unit_sel < 0) return(-1);
    }
 
-   char data[6] = {0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
+   unsigned char data[8] = {0};
+   int i, n = vec_desc[g].n;
+   if(bno_read_regs(bno, vec_desc[g].reg, data, 2 * n) != 0) return(-1);
+   raw_ptr->ts = bno->xfer;
+   raw_ptr->n = n;
+   raw_ptr->div = vec_desc[g].div[unit_sel & 0x01];
+   memset(raw_ptr->v, 0, sizeof(raw_ptr->v));
+   for(i = 0; i < n; i++) {
+      raw_ptr->v[i] = le16(&data[2 * i]);
+      BNO_DEBUG(bno->verbose, "Debug: %s %c: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n",
+                              vec_desc[g].name, vec_desc[g].axis[i], data[2 * i], data[2 * i + 1], raw_ptr->v[i]);
    }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Gyroscope Data X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->gdata_x = (double) buf / 16.0;
-
-   buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Gyrosscope Data Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->gdata_y = (double) buf / 16.0;
-
-   buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Gyroscope Data Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->gdata_z = (double) buf / 16.0;
    return(0);
 }
 
 /* ------------------------------------------------------------ *
- *  get_eul() - read Euler orientation into the global struct   *
+ *  get_raw() - read one data group, field is a single BNO_F_   *
+ *  vector flag, as int16 values without conversion and the     *
+ *  divisor that get_acc() - get_lin() apply to them.           *
  * ------------------------------------------------------------ */
-int get_eul(struct bnoeul *bnod_ptr) {
-   char reg = BNO055_EULER_H_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+int get_raw(bno055_t *bno, uint16_t field, struct bnoraw *raw_ptr) {
+   int g;
+   for(g = 0; g < VEC_COUNT && field != (1 << g); g++);
+   if(g == VEC_COUNT) {
+      BNO_ERROR("Error: get_raw() needs one data group, not 0x%04X.\n", field);
       return(-1);
    }
-
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
-
-   unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Euler Orientation H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->eul_head = (double) buf / 16.0;
-
-   buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Euler Orientation R: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->eul_roll = (double) buf / 16.0;
-
-   buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Euler Orientation P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->eul_pitc = (double) buf / 16.0;
-   return(0);
+   return(vec_read(bno, g, raw_ptr));
 }
 
 /* ------------------------------------------------------------ *
- *  get_qua() - read Quaternation data into the global struct   *
+ *  get_acc(), get_mag(), get_gyr(), get_eul(), get_qua(),      *
+ *  get_lin(), get_gra() - read one data vector into its struct *
+ *  in units: m/s2 or mg, microTesla, dps, degrees, quaternion  *
+ *  units, as set by UNIT_SEL for acceleration.                 *
  * ------------------------------------------------------------ */
-int get_qua(struct bnoqua *bnod_ptr) {
-   char reg = BNO055_QUATERNION_DATA_W_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   if(verbose == 1) printf("Debug: I2C read 8 bytes starting at register 0x%02X\n", reg);
-
-   unsigned char data[8] = {0};
-   if(read(i2cfd, data, 8) != 8) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0]; 
-   if(verbose == 1) printf("Debug: Quaternation W: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->quater_w = (double) buf / 16384.0;
-
-   buf = ((int16_t)data[3] << 8) | data[2]; 
-   if(verbose == 1) printf("Debug: Quaternation X: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->quater_x = (double) buf / 16384.0;
-
-   buf = ((int16_t)data[5] << 8) | data[4]; 
-   if(verbose == 1) printf("Debug: Quaternation Y: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->quater_y = (double) buf / 16384.0;
-
-   buf = ((int16_t)data[7] << 8) | data[6]; 
-   if(verbose == 1) printf("Debug: Quaternation Z: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[6], data[7],buf);
-   bnod_ptr->quater_z = (double) buf / 16384.0;
-   return(0);
+#define VEC_GET(f, F, reg, n, div0, div1, name, axis, ...) \
+int get_##f(bno055_t *bno, struct bno##f *bnod_ptr) { \
+   struct bnoraw raw; \
+   double v[4]; \
+   int i; \
+   if(vec_read(bno, VEC_##f, &raw) != 0) return(-1); \
+   for(i = 0; i < n; i++) v[i] = (double) raw.v[i] / raw.div; \
+   BNO_VEC_STORE##n(bnod_ptr, v, __VA_ARGS__); \
+   bnod_ptr->ts = raw.ts; \
+   return(0); \
 }
+BNO_VECTORS(VEC_GET)
 
 /* ------------------------------------------------------------ *
- *  get_gra() - read gravity vector into the global struct      *
+ * bno_snap_decode() - decode the raw data block 0x08-0x3B, as  *
+ * read by get_snapshot() or kept in a capture file. The scale  *
+ * factors are the same as used by get_acc() - get_lin(). The   *
+ * raw bytes are kept in snap_ptr->raw, timestamps are left to  *
+ * the caller.                                                  *
  * ------------------------------------------------------------ */
-int get_gra(struct bnogra *bnod_ptr) {
+void bno_snap_decode(const unsigned char *data, struct bnosnap *snap_ptr) {
+#define SNAP(r) (&data[(r) - SNAPSHOT_START])
+
    /* --------------------------------------------------------- *
-    * Get the unit conversion: 1 m/s2 = 100 LSB, 1 mg = 1 LSB   *
+    * UNIT_SEL bit-0: 1 m/s2 = 100 LSB, 1 mg = 1 LSB. The scale *
+    * of each vector is a constant of the BNO_VECTORS expansion *
     * --------------------------------------------------------- */
-   char reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-   char unit_sel;
-   if(read(i2cfd, &unit_sel, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
+   unsigned char unit_sel = *SNAP(BNO055_UNIT_SEL_ADDR);
+   int u = (unit_sel >> 0) & 0x01;
+   double v[4];
+   int i;
 
-   double ufact;
-   if((unit_sel >> 0) & 0x01) ufact = 1.0;
-   else ufact = 100.0;
+#define VEC_SNAP(f, F, reg, n, div0, div1, name, axis, ...) \
+   for(i = 0; i < n; i++) v[i] = (double) le16(SNAP(reg) + 2 * i) / (u ? div1 : div0); \
+   BNO_VEC_STORE##n(&snap_ptr->f, v, __VA_ARGS__);
+   BNO_VECTORS(VEC_SNAP)
+#undef VEC_SNAP
 
    /* --------------------------------------------------------- *
-    * Get the gravity vector data                               *
+    * Status bytes, calibration state is encoded as 4x 2bit     *
     * --------------------------------------------------------- */
-   reg = BNO055_GRAVITY_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
-
-   unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Gravity Vector H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->gravityx = (double) buf / ufact;
-
-   buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Gravity Vector M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->gravityy = (double) buf / ufact;
-
-   buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Gravity Vector P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->gravityz = (double) buf / ufact;
-   return(0);
+   unsigned char calib = *SNAP(BNO055_CALIB_STAT_ADDR);
+   snap_ptr->temp_val = *SNAP(BNO055_TEMP_ADDR);
+   snap_ptr->scal_st  = (calib & 0b11000000) >> 6;
+   snap_ptr->gcal_st  = (calib & 0b00110000) >> 4;
+   snap_ptr->acal_st  = (calib & 0b00001100) >> 2;
+   snap_ptr->mcal_st  = (calib & 0b00000011);
+   snap_ptr->selftest = *SNAP(BNO055_SELFTSTRES_ADDR) & 0x0F;
+   snap_ptr->intr_st  = *SNAP(BNO055_INTR_STAT_ADDR);
+   snap_ptr->clk_st   = *SNAP(BNO055_SYS_CLK_STAT_ADDR);
+   snap_ptr->sys_stat = *SNAP(BNO055_SYS_STAT_ADDR);
+   snap_ptr->sys_err  = *SNAP(BNO055_SYS_ERR_ADDR);
+   snap_ptr->unitsel  = unit_sel;
+#undef SNAP
+   memcpy(snap_ptr->raw, data, SNAPSHOT_BYTECOUNT);
 }
 
 /* ------------------------------------------------------------ *
- *  get_lin() - read linear acceleration into the global struct *
+ * get_snapshot() - read the complete data block 0x08-0x3B with *
+ * one burst and decode all vectors out of the same buffer.     *
  * ------------------------------------------------------------ */
-int get_lin(struct bnolin *bnod_ptr) {
-   /* --------------------------------------------------------- *
-    * Get the unit conversion: 1 m/s2 = 100 LSB, 1 mg = 1 LSB   *
-    * --------------------------------------------------------- */
-   char reg = BNO055_UNIT_SEL_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-   char unit_sel;
-   if(read(i2cfd, &unit_sel, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   double ufact;
-   if((unit_sel >> 0) & 0x01) ufact = 1.0;
-   else ufact = 100.0;
-
-   /* --------------------------------------------------------- *
-    * Get the linear acceleration data                          *
-    * --------------------------------------------------------- */
-   reg = BNO055_LIN_ACC_DATA_X_LSB_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   if(verbose == 1) printf("Debug: I2C read 6 bytes starting at register 0x%02X\n", reg);
-
-   unsigned char data[6] = {0, 0, 0, 0, 0, 0};
-   if(read(i2cfd, data, 6) != 6) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
-
-   int16_t buf = ((int16_t)data[1] << 8) | data[0];
-   if(verbose == 1) printf("Debug: Linear Acceleration H: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[0], data[1],buf);
-   bnod_ptr->linacc_x = (double) buf / ufact;
-
-   buf = ((int16_t)data[3] << 8) | data[2];
-   if(verbose == 1) printf("Debug: Linear Acceleration M: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[2], data[3],buf);
-   bnod_ptr->linacc_y = (double) buf / ufact;
-
-   buf = ((int16_t)data[5] << 8) | data[4];
-   if(verbose == 1) printf("Debug: Linear Acceleration P: LSB [0x%02X] MSB [0x%02X] INT16 [%d]\n", data[4], data[5],buf);
-   bnod_ptr->linacc_z = (double) buf / ufact;
+int get_snapshot(bno055_t *bno, struct bnosnap *snap_ptr) {
+   unsigned char data[SNAPSHOT_BYTECOUNT] = {0};
+   if(bno_read_regs(bno, SNAPSHOT_START, data, SNAPSHOT_BYTECOUNT) != 0) return(-1);
+   bno_snap_decode(data, snap_ptr);
+
+   snap_ptr->ts     = bno->xfer;
+   snap_ptr->acc.ts = snap_ptr->mag.ts = snap_ptr->gyr.ts = bno->xfer;
+   snap_ptr->eul.ts = snap_ptr->qua.ts = bno->xfer;
+   snap_ptr->lin.ts = snap_ptr->gra.ts = bno->xfer;
+
+   BNO_DEBUG(bno->verbose, "Debug: Snapshot EUL H [%3.4f] R [%3.4f] P [%3.4f] CAL [0x%02X]\n",
+                           snap_ptr->eul.eul_head, snap_ptr->eul.eul_roll, snap_ptr->eul.eul_pitc,
+                           data[BNO055_CALIB_STAT_ADDR - SNAPSHOT_START]);
    return(0);
 }
 
@@ -869,19 +1191,16 @@ int get_lin(struct bnolin *bnod_ptr) {
  * The modes cannot be switched over directly, first it needs   *
  * to be set to "config" mode before switching to the new mode. *
  * ------------------------------------------------------------ */
-int set_mode(opmode_t newmode) {
+int set_mode(bno055_t *bno, opmode_t newmode) {
    char data[2] = {0};
    data[0] = BNO055_OPR_MODE_ADDR;
-   opmode_t oldmode = get_mode();
+   opmode_t oldmode = get_mode(bno);
 
    if(oldmode == newmode) return(0); // if new mode is the same
    else if(oldmode > 0 && newmode > 0) {  // switch to "config" first
       data[1] = 0x0;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-         return(-1);
-      }
+      BNO_DEBUG(bno->verbose, "Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
       /* --------------------------------------------------------- *
        * switch time: any->config needs 7ms + small buffer = 10ms  *
        * --------------------------------------------------------- */
@@ -889,39 +1208,32 @@ int set_mode(opmode_t newmode) {
    }
 
    data[1] = newmode;
-   if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      return(-1);
-   }
+   BNO_DEBUG(bno->verbose, "Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
    /* --------------------------------------------------------- *
     * switch time: config->any needs 19ms + small buffer = 25ms *
     * --------------------------------------------------------- */
    usleep(25 * 1000);
 
-   if(get_mode() == newmode) return(0);
+   /* --------------------------------------------------------- *
+    * verify with a real read, it also refreshes the shadow     *
+    * --------------------------------------------------------- */
+   unsigned char check = 0;
+   if(bno_read_regs(bno, BNO055_OPR_MODE_ADDR, &check, 1) != 0) return(-1);
+   if((check & 0x0F) == newmode) return(0);
    else return(-1);
 }
 
 /* ------------------------------------------------------------ *
  * get_mode() - returns sensor operational mode register 0x3D   *
- * Reads 1 byte from Operations Mode register 0x3d, and uses    *
- * only the lowest 4 bit. Bits 4-7 are unused, stripped off     *
+ * from the register shadow, and uses only the lowest 4 bit.    *
+ * Bits 4-7 are unused, stripped off                            *
  * ------------------------------------------------------------ */
-int get_mode() {
-   int reg = BNO055_OPR_MODE_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
+int get_mode(bno055_t *bno) {
+   int data = bno_shadow_get(bno, 0, BNO055_OPR_MODE_ADDR);
+   if(data < 0) return(-1);
 
-   if(verbose == 1) printf("Debug: Operation Mode: [0x%02X]\n", data & 0x0F);
+   BNO_DEBUG(bno->verbose, "Debug: Operation Mode: [0x%02X]\n", data & 0x0F);
 
    return(data & 0x0F);  // only return the lowest 4 bits
 }
@@ -982,13 +1294,13 @@ int print_mode(int mode) {
  * The power modes cannot be switched over directly, first the  *
  * ops mode needs to be "config"  to write the new power mode.  *
  * ------------------------------------------------------------ */
-int set_power(power_t pwrmode) {
+int set_power(bno055_t *bno, power_t pwrmode) {
    char data[2] = {0};
 
 /* ------------------------------------------------------------ *
  * Check what operational mode we are in                        *
  * ------------------------------------------------------------ */
-   opmode_t oldmode = get_mode();
+   opmode_t oldmode = get_mode(bno);
 
 /* ------------------------------------------------------------ *
  * If ops mode wasn't config, switch to "CONFIG" mode first     *
@@ -996,11 +1308,8 @@ int set_power(power_t pwrmode) {
    if(oldmode > 0) {
       data[0] = BNO055_OPR_MODE_ADDR;
       data[1] = 0x0;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-         return(-1);
-      }
+      BNO_DEBUG(bno->verbose, "Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
       usleep(30 * 1000);
    }  // now we are in config mode
 
@@ -1009,11 +1318,8 @@ int set_power(power_t pwrmode) {
  * ------------------------------------------------------------ */
    data[0] = BNO055_PWR_MODE_ADDR;
    data[1] = pwrmode;
-   if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      return(-1);
-   }
+   BNO_DEBUG(bno->verbose, "Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
    usleep(30 * 1000);
 
 /* ------------------------------------------------------------ *
@@ -1022,36 +1328,26 @@ int set_power(power_t pwrmode) {
    if(oldmode > 0) {
       data[0] = BNO055_OPR_MODE_ADDR;
       data[1] = oldmode;
-      if(verbose == 1) printf("Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-      if(write(i2cfd, data, 2) != 2) {
-         printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-         return(-1);
-      }
+      BNO_DEBUG(bno->verbose, "Debug: Write opr_mode: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+      if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
       usleep(30 * 1000);
    }  // now the previous mode is back
 
-   if(get_power() == pwrmode) return(0);
+   unsigned char check = 0;
+   if(bno_read_regs(bno, BNO055_PWR_MODE_ADDR, &check, 1) != 0) return(-1);
+   if((check & 0x03) == pwrmode) return(0);
    else return(-1);
 }
 
 /* ------------------------------------------------------------ *
  * get_power() returns the sensor power mode from register 0x3e *
- * Only the lowest 2 bit are used, ignore the unused bits 2-7.  *
+ * (shadowed). Only the lowest 2 bit are used, ignore bits 2-7. *
  * ------------------------------------------------------------ */
-int get_power() {
-   int reg = BNO055_PWR_MODE_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
+int get_power(bno055_t *bno) {
+   int data = bno_shadow_get(bno, 0, BNO055_PWR_MODE_ADDR);
+   if(data < 0) return(-1);
 
-   if(verbose == 1) printf("Debug:     Power Mode: [0x%02X] 2bit [0x%02X]\n", data, data & 0x03);
+   BNO_DEBUG(bno->verbose, "Debug:     Power Mode: [0x%02X] 2bit [0x%02X]\n", data, data & 0x03);
 
    return(data & 0x03);  // only return the lowest 2 bits
 }
@@ -1080,20 +1376,11 @@ int print_power(int mode) {
 /* ------------------------------------------------------------ *
  * get_sstat() returns the sensor sys status from register 0x39 *
  * ------------------------------------------------------------ */
-int get_sstat() {
-   int reg = BNO055_SYS_STAT_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      return(-1);
-   }
-
-   unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
+int get_sstat(bno055_t *bno) {
+   unsigned char data = 0;
+   if(bno_read_regs(bno, BNO055_SYS_STAT_ADDR, &data, 1) != 0) return(-1);
 
-   if(verbose == 1) printf("Debug:  System Status: [0x%02X]\n", data);
+   BNO_DEBUG(bno->verbose, "Debug:  System Status: [0x%02X]\n", data);
 
    return(data);
 }
@@ -1134,28 +1421,21 @@ int print_sstat(int stat_code) {
 /* ------------------------------------------------------------ *
  * get_remap() returns axis remap data from registers 0x41 0x42 *
  * ------------------------------------------------------------ */
-int get_remap(char mode) {
+int get_remap(bno055_t *bno, char mode) {
    int reg;
 
    if(mode == 'c') reg = BNO055_AXIS_MAP_CONFIG_ADDR;
    else if(mode == 's') reg = BNO055_AXIS_MAP_SIGN_ADDR;
    else {
-      printf("Error: Unknown remap function mode %c.\n", mode);
-      exit(-1);
-   }
-
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
+      BNO_ERROR("Error: Unknown remap function mode %c.\n", mode);
+      errno = EINVAL;
       return(-1);
    }
 
-   unsigned int data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      return(-1);
-   }
+   int data = bno_shadow_get(bno, 0, reg);
+   if(data < 0) return(-1);
 
-   if(verbose == 1) printf("Debug: Axis Remap '%c': [0x%02X]\n", mode, data);
+   BNO_DEBUG(bno->verbose, "Debug: Axis Remap '%c': [0x%02X]\n", mode, data);
 
    return(data);
 }
@@ -1225,116 +1505,130 @@ int print_remap_sign(int mode) {
 }
 
 /* ------------------------------------------------------------ *
- * set_page0() - Set page ID = 0 to set default register access *
+ * set_page() - Set the register map page ID. The current page  *
+ * is tracked in the shadow, a write to the page that is set    *
+ * already is skipped.                                          *
  * ------------------------------------------------------------ */
-int set_page0() {
+static int set_page(bno055_t *bno, int pg) {
+   if(bno->shadow.page == pg) return(0);
    char data[2] = {0};
    data[0] = BNO055_PAGE_ID_ADDR;
-   data[1] = 0x0;
-   if(verbose == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      return(-1);
-   }
+   data[1] = pg;
+   BNO_DEBUG(bno->verbose, "Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
+   if(bno_write_reg(bno, data[0], data[1]) != 0) return(-1);
    return(0);
 }
 
+/* ------------------------------------------------------------ *
+ * set_page0() - Set page ID = 0 to set default register access *
+ * ------------------------------------------------------------ */
+int set_page0(bno055_t *bno) {
+   return set_page(bno, 0);
+}
+
 /* ------------------------------------------------------------ *
  * set_page1() - Set page ID = 1 to switch the register access  *
  * ------------------------------------------------------------ */
-int set_page1() {
-   char data[2] = {0};
-   data[0] = BNO055_PAGE_ID_ADDR;
-   data[1] = 0x1;
-   if(verbose == 1) printf("Debug: write page-ID: [0x%02X] to register [0x%02X]\n", data[1], data[0]);
-   if(write(i2cfd, data, 2) != 2) {
-      printf("Error: I2C write failure for register 0x%02X\n", data[0]);
-      return(-1);
-   }
-   return(0);
+int set_page1(bno055_t *bno) {
+   return set_page(bno, 1);
 }
 
 /* ------------------------------------------------------------ *
  * get_clksrc() - return setting for internal/external clock    *
  * ------------------------------------------------------------ */
-int get_clksrc() {
-   char reg = BNO055_SYS_TRIGGER_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
-      return(-1);
-   }
-
-   char data;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
-      return(-1);
-   }
+int get_clksrc(bno055_t *bno) {
+   unsigned char data = 0;
+   if(bno_read_regs(bno, BNO055_SYS_TRIGGER_ADDR, &data, 1) != 0) return(-1);
 
-   if(verbose == 1) printf("Debug: CLK_SEL bit-7 in register %d: [%d]\n", reg, (data & 0b10000000) >> 7);
+   BNO_DEBUG(bno->verbose, "Debug: CLK_SEL bit-7 in register %d: [%d]\n", BNO055_SYS_TRIGGER_ADDR, (data & 0b10000000) >> 7);
    return (data & 0b10000000) >> 7; // system calibration status
 }
 
 /* ------------------------------------------------------------ *
  * print_clksrc() - print setting for internal/external clock   *
  * ------------------------------------------------------------ */
-void print_clksrc() {
-   int src = get_clksrc();
+void print_clksrc(bno055_t *bno) {
+   int src = get_clksrc(bno);
    if(src == 0) printf("Internal Clock (default)\n");
    if(src == 1) printf("External Clock\n");
    if(src == -1) printf("Clock Reading error\n");
 }
 
 /* ------------------------------------------------------------ *
- * get_acc_conf() read accelerometer config into global struct  *
- * Requires switching register page 0->1 and back after reading *
+ * get_conf() read the page-1 sensor configuration registers    *
+ * 0x08..0x0D with one burst (via the register shadow) and fill *
+ * the accelerometer, magnetometer and gyroscope config structs.*
+ * Any of the struct pointers can be NULL if not needed.        *
  * ------------------------------------------------------------ */
-int get_acc_conf(struct bnoaconf *bnoc_ptr) {
-
-   set_page1();
-   char reg = BNO055_ACC_CONFIG_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
-      return(-1);
-   }
-
-   char data;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
-      return(-1);
-   }
-
-   bnoc_ptr->range   = (data & 0b00000011) >> 2; // accel range
-   if(verbose == 1) printf("Debug:       accelerometer range: [%d]\n", bnoc_ptr->pwrmode);
-   bnoc_ptr->bandwth = (data & 0b00011100) >> 4; // accel bandwidth
-   if(verbose == 1) printf("Debug:   accelerometer bandwidth: [%d]\n", bnoc_ptr->bandwth);
-   bnoc_ptr->pwrmode = (data & 0b11100000) >> 6; // accel power mode
-   if(verbose == 1) printf("Debug:  accelerometer power mode: [%d]\n", bnoc_ptr->pwrmode);
-
-   reg = BNO055_ACC_SLEEP_CONFIG_ADDR;
-   if(write(i2cfd, &reg, 1) != 1) {
-      printf("Error: I2C write failure for register 0x%02X\n", reg);
-      set_page0();
-      return(-1);
+int get_conf(bno055_t *bno, struct bnoaconf *acc_ptr, struct bnomconf *mag_ptr, struct bnogconf *gyr_ptr) {
+   int pg = bno->shadow.page;
+   if(!bno->shadow.valid[1] && bno_shadow_load(bno, 1) != 0) return(-1);
+   if(pg == 1 && set_page1(bno) != 0) return(-1);      // restore page 1
+
+   unsigned char *p1 = bno->shadow.p1;
+   unsigned char acc  = p1[BNO055_ACC_CONFIG_ADDR - SHADOW_P1_START];
+   unsigned char mag  = p1[BNO055_MAG_CONFIG_ADDR - SHADOW_P1_START];
+   unsigned char gyr0 = p1[BNO055_GYR_CONFIG0_ADDR - SHADOW_P1_START];
+   unsigned char gyr1 = p1[BNO055_GYR_CONFIG1_ADDR - SHADOW_P1_START];
+   unsigned char aslp = p1[BNO055_ACC_SLEEP_CONFIG_ADDR - SHADOW_P1_START];
+   unsigned char gslp = p1[BNO055_GYR_SLEEP_CONFIG_ADDR - SHADOW_P1_START];
+
+   if(acc_ptr != NULL) {
+      acc_ptr->range   = (acc & 0b00000011);      // accel range
+      BNO_DEBUG(bno->verbose, "Debug:       accelerometer range: [%d]\n", acc_ptr->range);
+      acc_ptr->bandwth = (acc & 0b00011100) >> 2; // accel bandwidth
+      BNO_DEBUG(bno->verbose, "Debug:   accelerometer bandwidth: [%d]\n", acc_ptr->bandwth);
+      acc_ptr->pwrmode = (acc & 0b11100000) >> 5; // accel power mode
+      BNO_DEBUG(bno->verbose, "Debug:  accelerometer power mode: [%d]\n", acc_ptr->pwrmode);
+      acc_ptr->slpmode = (aslp & 0b00000001);     // accel sleep mode
+      BNO_DEBUG(bno->verbose, "Debug:  accelerometer sleep mode: [%d]\n", acc_ptr->slpmode);
+      acc_ptr->slpdur  = (aslp & 0b00011110) >> 1; // accel sleep duration
+      BNO_DEBUG(bno->verbose, "Debug:   accelerometer sleep dur: [%d]\n", acc_ptr->slpdur);
+   }
+
+   if(mag_ptr != NULL) {
+      mag_ptr->outrate = (mag & 0b00000111);      // mag data output rate
+      BNO_DEBUG(bno->verbose, "Debug:   magnetometer output rate: [%d]\n", mag_ptr->outrate);
+      mag_ptr->oprmode = (mag & 0b00011000) >> 3; // mag operation mode
+      BNO_DEBUG(bno->verbose, "Debug:   magnetometer operation: [%d]\n", mag_ptr->oprmode);
+      mag_ptr->pwrmode = (mag & 0b01100000) >> 5; // mag power mode
+      BNO_DEBUG(bno->verbose, "Debug:   magnetometer power mode: [%d]\n", mag_ptr->pwrmode);
+   }
+
+   if(gyr_ptr != NULL) {
+      gyr_ptr->range   = (gyr0 & 0b00000111);      // gyro range
+      BNO_DEBUG(bno->verbose, "Debug:           gyroscope range: [%d]\n", gyr_ptr->range);
+      gyr_ptr->bandwth = (gyr0 & 0b00111000) >> 3; // gyro bandwidth
+      BNO_DEBUG(bno->verbose, "Debug:       gyroscope bandwidth: [%d]\n", gyr_ptr->bandwth);
+      gyr_ptr->pwrmode = (gyr1 & 0b00000111);      // gyro power mode
+      BNO_DEBUG(bno->verbose, "Debug:      gyroscope power mode: [%d]\n", gyr_ptr->pwrmode);
+      gyr_ptr->slpdur  = (gslp & 0b00000111);      // gyro sleep duration
+      BNO_DEBUG(bno->verbose, "Debug:       gyroscope sleep dur: [%d]\n", gyr_ptr->slpdur);
+      gyr_ptr->aslpdur = (gslp & 0b00111000) >> 3; // gyro auto sleep duration
+      BNO_DEBUG(bno->verbose, "Debug:  gyroscope auto sleep dur: [%d]\n", gyr_ptr->aslpdur);
    }
+   return(0);
+}
 
-   data = 0;
-   if(read(i2cfd, &data, 1) != 1) {
-      printf("Error: I2C read failure for register data 0x%02X\n", reg);
-      set_page0();
-      return(-1);
-   }
+/* ------------------------------------------------------------ *
+ * get_acc_conf() read accelerometer config into global struct  *
+ * ------------------------------------------------------------ */
+int get_acc_conf(bno055_t *bno, struct bnoaconf *bnoc_ptr) {
+   return get_conf(bno, bnoc_ptr, NULL, NULL);
+}
 
-   bnoc_ptr->slpmode = (data & 0b00000011) >> 2; // accel sleep mode
-   if(verbose == 1) printf("Debug:  accelerometer sleep mode: [%d]\n", bnoc_ptr->slpmode);
-   bnoc_ptr->slpdur = (data & 0b00011100) >> 4; // accel sleep duration
-   if(verbose == 1) printf("Debug:   accelerometer sleep dur: [%d]\n", bnoc_ptr->slpdur);
+/* ------------------------------------------------------------ *
+ * get_mag_conf() read magnetometer config into global struct   *
+ * ------------------------------------------------------------ */
+int get_mag_conf(bno055_t *bno, struct bnomconf *bnoc_ptr) {
+   return get_conf(bno, NULL, bnoc_ptr, NULL);
+}
 
-   set_page0();
-   return(0);
+/* ------------------------------------------------------------ *
+ * get_gyr_conf() read gyroscope config into global struct      *
+ * ------------------------------------------------------------ */
+int get_gyr_conf(bno055_t *bno, struct bnogconf *bnoc_ptr) {
+   return get_conf(bno, NULL, NULL, bnoc_ptr);
 }
 
 /* ----------------------------------------------------------- *
@@ -1447,3 +1741,35 @@ void print_acc_conf(struct bnoaconf *bnoc_ptr) {
          break;
    }
 }
+
+/* ----------------------------------------------------------- *
+ *  print_mag_conf() - print magnetometer configuration        *
+ * ----------------------------------------------------------- */
+void print_mag_conf(struct bnomconf *bnoc_ptr) {
+   const char *pwr[] = { "NORMAL", "SLEEP", "SUSPEND", "FORCE MODE" };
+   const char *opr[] = { "LOW POWER", "REGULAR", "ENHANCED REGULAR", "HIGH ACCURACY" };
+   const char *odr[] = { "2Hz", "6Hz", "8Hz", "10Hz", "15Hz", "20Hz", "25Hz", "30Hz" };
+
+   printf("Magnetometer   Power = %s\n", pwr[bnoc_ptr->pwrmode & 0x03]);
+   printf("Magnetometer  OpMode = %s\n", opr[bnoc_ptr->oprmode & 0x03]);
+   printf("Magnetometer  Output = %s\n", odr[bnoc_ptr->outrate & 0x07]);
+}
+
+/* ----------------------------------------------------------- *
+ *  print_gyr_conf() - print gyroscope configuration           *
+ * ----------------------------------------------------------- */
+void print_gyr_conf(struct bnogconf *bnoc_ptr) {
+   const char *pwr[] = { "NORMAL", "FAST POWERUP", "DEEP SUSPEND", "SUSPEND",
+                         "ADVANCED POWERSAVE", "RESERVED", "RESERVED", "RESERVED" };
+   const char *bw[]  = { "523Hz", "230Hz", "116Hz", "47Hz", "23Hz", "12Hz", "64Hz", "32Hz" };
+   const char *rng[] = { "2000dps", "1000dps", "500dps", "250dps", "125dps",
+                         "RESERVED", "RESERVED", "RESERVED" };
+   const char *slp[] = { "2ms", "4ms", "5ms", "8ms", "10ms", "15ms", "18ms", "20ms" };
+   const char *aslp[]= { "not allowed", "4ms", "5ms", "8ms", "10ms", "15ms", "20ms", "40ms" };
+
+   printf("Gyroscope      Power = %s\n", pwr[bnoc_ptr->pwrmode & 0x07]);
+   printf("Gyroscope     Bwidth = %s\n", bw[bnoc_ptr->bandwth & 0x07]);
+   printf("Gyroscope     Range  = %s\n", rng[bnoc_ptr->range & 0x07]);
+   printf("Gyroscope      Sleep = %s, auto sleep %s\n",
+          slp[bnoc_ptr->slpdur & 0x07], aslp[bnoc_ptr->aslpdur & 0x07]);
+}
@@ -0,0 +1,177 @@
+/* ------------------------------------------------------------ *
+ * file:        int_bno055.c                                    *
+ * purpose:     Interrupt driven data acquisition. Configures   *
+ *              the sensor interrupts (INT_EN/INT_MSK, page 1), *
+ *              waits for the INT pin edge on a GPIO line with  *
+ *              the Linux gpiochip character device (uAPI v2),  *
+ *              and releases the latched pin with RST_INT. With *
+ *              the simulator, its INT pin stand-in is used.    *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/gpio.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * set_intr() - enable the interrupts in mask (BNO055_INT_ bits)*
+ * and route them to the INT pin, 0 disables all. INT_MSK and   *
+ * INT_EN are adjacent page-1 registers, written in one burst.  *
+ * The registers only accept writes in CONFIG mode.             *
+ * ------------------------------------------------------------ */
+int set_intr(bno055_t *bno, int mask) {
+   int oldmode = get_mode(bno);
+   if(oldmode < 0) return(-1);
+   if(oldmode != config && set_mode(bno, config) != 0) return(-1);
+
+   unsigned char data[2];
+   data[0] = mask;   // INT_MSK: drive the INT pin
+   data[1] = mask;   // INT_EN: set the INTR_STAT bits
+   BNO_DEBUG(bno->verbose, "Debug: Write INT_MSK/INT_EN: [0x%02X] to register [0x%02X]\n", mask, BNO055_INT_MSK_ADDR);
+
+   int res = -1;
+   if(set_page1(bno) == 0) {
+      res = bno_write_regs(bno, BNO055_INT_MSK_ADDR, data, 2);
+      if(set_page0(bno) != 0) res = -1;
+   }
+
+   if(oldmode != config && set_mode(bno, oldmode) != 0) return(-1);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * get_intr() - returns the interrupt status register 0x37. The *
+ * snapshot data block read by get_snapshot() includes it too.  *
+ * ------------------------------------------------------------ */
+int get_intr(bno055_t *bno) {
+   unsigned char data = 0;
+   if(bno_read_regs(bno, BNO055_INTR_STAT_ADDR, &data, 1) != 0) return(-1);
+
+   BNO_DEBUG(bno->verbose, "Debug: Interrupt Status: [0x%02X]\n", data);
+   return(data);
+}
+
+/* ------------------------------------------------------------ *
+ * gpio_line_open() - request one line of a gpiochip as input,  *
+ * with rising edge events. line format: <chip>:<offset>, chip  *
+ * as gpiochip0 or /dev/gpiochip0. Returns the line request fd. *
+ * ------------------------------------------------------------ */
+static int gpio_line_open(bno055_t *bno, const char *line) {
+   char chip[256];
+   const char *colon = strrchr(line, ':');
+   int len = colon - line;
+
+   if(len <= 0 || len >= (int) sizeof(chip) - 5) {
+      BNO_ERROR("Error: invalid GPIO line [%s].\n", line);
+      return(-1);
+   }
+   if(line[0] == '/') snprintf(chip, sizeof(chip), "%.*s", len, line);
+   else snprintf(chip, sizeof(chip), "/dev/%.*s", len, line);
+
+   int chipfd = open(chip, O_RDWR | O_CLOEXEC);
+   if(chipfd < 0) {
+      BNO_ERROR("Error: cannot open GPIO chip [%s].\n", chip);
+      return(-1);
+   }
+
+   struct gpio_v2_line_request req;
+   memset(&req, 0, sizeof(req));
+   req.offsets[0] = strtoul(colon + 1, NULL, 10);
+   req.num_lines = 1;
+   req.config.flags = GPIO_V2_LINE_FLAG_INPUT | GPIO_V2_LINE_FLAG_EDGE_RISING;
+   strncpy(req.consumer, "bno055-int", sizeof(req.consumer) - 1);
+
+   int res = ioctl(chipfd, GPIO_V2_GET_LINE_IOCTL, &req);
+   close(chipfd);
+   if(res < 0) {
+      BNO_ERROR("Error: cannot request GPIO line %u on [%s].\n", req.offsets[0], chip);
+      return(-1);
+   }
+   BNO_DEBUG(bno->verbose, "Debug: INT pin on GPIO [%s] line [%u]\n", chip, req.offsets[0]);
+   return(req.fd);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_irq_open() - attach the sensor INT pin. line is a GPIO   *
+ * as <chip>:<offset>, e.g. gpiochip0:17. Without a ':' (or if  *
+ * NULL) the bus backend's own INT line is used, e.g. "sim".    *
+ * ------------------------------------------------------------ */
+int bno_irq_open(bno055_t *bno, const char *line) {
+   bno_irq_close(bno);
+
+   if(line != NULL && strchr(line, ':') != NULL) {
+      bno->irqfd = gpio_line_open(bno, line);
+      bno->irqgpio = 1;
+   }
+   else if(bno->bus.irq_line != NULL) {
+      bno->irqfd = bno->bus.irq_line(&bno->bus);
+      bno->irqgpio = 0;
+      BNO_DEBUG(bno->verbose, "Debug: INT pin from bus transport [%s]\n", bno->bus.name);
+   }
+   else BNO_ERROR("Error: bus transport [%s] has no INT line, use <gpiochip>:<line>.\n", bno->bus.name);
+   if(bno->irqfd < 0) return(-1);
+
+   /* --------------------------------------------------------- *
+    * RST_INT shares SYS_TRIGGER with CLK_SEL, keep that bit    *
+    * --------------------------------------------------------- */
+   int clk = get_clksrc(bno);
+   if(clk < 0) {
+      bno_irq_close(bno);
+      return(-1);
+   }
+   bno->irqtrig = clk << 7;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_irq_wait() - wait up to timeout_ms (-1 = forever) for a  *
+ * rising edge on the INT pin. Returns 1 for an interrupt, 0 on *
+ * timeout and -1 on errors. The pin stays high until cleared.  *
+ * ------------------------------------------------------------ */
+int bno_irq_wait(bno055_t *bno, int timeout_ms) {
+   struct pollfd pfd = { bno->irqfd, POLLIN, 0 };
+   int res;
+
+   if(bno->irqfd < 0) return(-1);
+   while((res = poll(&pfd, 1, timeout_ms)) < 0 && errno == EINTR);
+   if(res <= 0) return(res);
+
+   /* --------------------------------------------------------- *
+    * consume the queued edge events, one wakeup per interrupt  *
+    * --------------------------------------------------------- */
+   if(bno->irqgpio == 1) {
+      struct gpio_v2_line_event ev[16];
+      if(read(bno->irqfd, ev, sizeof(ev)) < 0 && errno != EAGAIN) return(-1);
+   }
+   else {
+      uint64_t count;
+      if(read(bno->irqfd, &count, sizeof(count)) < 0 && errno != EAGAIN) return(-1);
+   }
+   return(1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_irq_clear() - reset INTR_STAT and the latched INT pin by *
+ * setting RST_INT, SYS_TRIGGER bit-6. One register write.      *
+ * ------------------------------------------------------------ */
+int bno_irq_clear(bno055_t *bno) {
+   return bno_write_reg(bno, BNO055_SYS_TRIGGER_ADDR, 0x40 | bno->irqtrig);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_irq_close() - release the GPIO line, a backend INT line  *
+ * stays owned by the backend.                                  *
+ * ------------------------------------------------------------ */
+void bno_irq_close(bno055_t *bno) {
+   if(bno->irqfd >= 0 && bno->irqgpio == 1) close(bno->irqfd);
+   bno->irqfd = -1;
+   bno->irqgpio = 0;
+}
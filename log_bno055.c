@@ -0,0 +1,176 @@
+/* ------------------------------------------------------------ *
+ * file:        log_bno055.c                                    *
+ * purpose:     Library diagnostics: the bno_log() message sink *
+ *              behind BNO_DEBUG() and BNO_ERROR(), and the     *
+ *              per-handle binary trace ring of register bus    *
+ *              transactions. Recording a transaction stores 24 *
+ *              bytes, formatting is left to bno_trace_dump()   *
+ *              when someone asks for it. bno_errs_dump() shows *
+ *              the bus error counters of a handle.             *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <errno.h>
+#include "getbno055.h"
+
+static bno_logfn log_fn = NULL;
+
+/* ------------------------------------------------------------ *
+ * bno_log_set() - send library messages to fn instead, e.g. to *
+ * syslog in a daemon. NULL restores the default streams.       *
+ * ------------------------------------------------------------ */
+void bno_log_set(bno_logfn fn) {
+   log_fn = fn;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_log() - write a library message. Errors go to stderr so  *
+ * they never mix with data on stdout, debug lines to stdout in *
+ * order with the program output they explain. errno is kept.   *
+ * ------------------------------------------------------------ */
+void bno_log(int level, const char *fmt, ...) {
+   int err = errno;
+   va_list ap;
+   va_start(ap, fmt);
+   if(log_fn != NULL) {
+      char msg[512];
+      vsnprintf(msg, sizeof(msg), fmt, ap);
+      log_fn(level, msg);
+   }
+   else {
+      if(level == BNO_LOG_ERR) fflush(stdout);
+      vfprintf(level == BNO_LOG_ERR ? stderr : stdout, fmt, ap);
+   }
+   va_end(ap);
+   errno = err;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_start() - record the last n (rounded up to a power *
+ * of 2) register transactions of the handle. Restarting clears *
+ * the ring. Not to be called while another thread uses bno.    *
+ * ------------------------------------------------------------ */
+int bno_trace_start(bno055_t *bno, int n) {
+   uint32_t size = 1;
+   if(n < 1 || n > (1 << 24)) {
+      BNO_ERROR("Error: trace ring size %d, not 1..%d.\n", n, 1 << 24);
+      return(-1);
+   }
+   while(size < (uint32_t) n) size <<= 1;
+
+   struct bnotrace *tr = calloc(1, sizeof(struct bnotrace) + size * sizeof(struct bnotrent));
+   if(tr == NULL) {
+      BNO_ERROR("Error: Cannot allocate a trace ring of %u entries.\n", size);
+      return(-1);
+   }
+   tr->mask = size - 1;
+   bno_trace_stop(bno);
+   bno->trace = tr;
+   BNO_DEBUG(bno->verbose, "Debug: Tracing the last %u bus transactions\n", size);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_stop() - stop recording and free the ring          *
+ * ------------------------------------------------------------ */
+void bno_trace_stop(bno055_t *bno) {
+   free(bno->trace);
+   bno->trace = NULL;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_rec() - record one transaction that started at t0, *
+ * called by the register access functions while tracing is on. *
+ * result is the transport return, errno holds the failure.     *
+ * ------------------------------------------------------------ */
+void bno_trace_rec(bno055_t *bno, int op, unsigned char reg, int len, int count,
+                   int result, const struct timespec *t0) {
+   struct bnotrace *tr = bno->trace;
+   struct timespec t1;
+   int err = errno;
+   clock_gettime(CLOCK_MONOTONIC_RAW, &t1);
+
+   uint32_t seq = tr->seq + 1;
+   struct bnotrent *e = &tr->ent[seq & tr->mask];
+   __atomic_store_n(&e->seq, 0, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   e->op        = op;
+   e->reg       = reg;
+   e->page      = bno->shadow.page < 0 ? 0xFF : bno->shadow.page;
+   e->count     = count;
+   e->len       = len;
+   e->result    = result == 0 ? 0 : (err > 0 ? -err : -EIO);
+   e->tstamp_ns = (int64_t) t0->tv_sec * 1000000000LL + t0->tv_nsec;
+   e->dur_ns    = (t1.tv_sec - t0->tv_sec) * 1000000000L + (t1.tv_nsec - t0->tv_nsec);
+   __atomic_store_n(&e->seq, seq, __ATOMIC_RELEASE);
+   __atomic_store_n(&tr->seq, seq, __ATOMIC_RELEASE);
+   errno = err;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_trace_dump() - print the recorded transactions to fd,    *
+ * oldest first, times relative to the first one. Safe while a  *
+ * bus worker keeps recording, entries it overwrites meanwhile  *
+ * are left out. Returns the number printed, -1 if not tracing. *
+ * ------------------------------------------------------------ */
+int bno_trace_dump(bno055_t *bno, int fd) {
+   static const char *ops[] = { "read", "write", "multi" };
+   if(bno == NULL || bno->trace == NULL) return(-1);
+   struct bnotrace *tr = bno->trace;
+
+   uint32_t last = __atomic_load_n(&tr->seq, __ATOMIC_ACQUIRE);
+   uint32_t n = last > tr->mask + 1 ? tr->mask + 1 : last;
+   uint32_t s;
+   int64_t t_first = -1;
+   int printed = 0, failed = 0;
+
+   dprintf(fd, "Trace of %s@0x%02X, %u transactions, the last %u:\n",
+               bno->bus.name, bno->addr, last, n);
+   dprintf(fd, "     seq   t [ms]  op     page reg   len   us    result\n");
+   for(s = last - n + 1; s != last + 1; s++) {
+      struct bnotrent *e = &tr->ent[s & tr->mask];
+      struct bnotrent copy;
+      if(__atomic_load_n(&e->seq, __ATOMIC_ACQUIRE) != s) continue;
+      memcpy(&copy, e, sizeof(copy));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if(__atomic_load_n(&e->seq, __ATOMIC_RELAXED) != s) continue;
+
+      if(t_first < 0) t_first = copy.tstamp_ns;
+      char page[8];
+      if(copy.page == 0xFF) snprintf(page, sizeof(page), "?");
+      else snprintf(page, sizeof(page), "%d", copy.page);
+      dprintf(fd, "%8u %8.3f  %-5s  %-4s 0x%02X %5d %6.1f  %s",
+                  copy.seq, (copy.tstamp_ns - t_first) / 1e6, ops[copy.op % 3], page, copy.reg,
+                  copy.len, copy.dur_ns / 1e3, copy.result == 0 ? "OK" : strerror(-copy.result));
+      if(copy.count > 1) dprintf(fd, " (%d blocks)", copy.count);
+      dprintf(fd, "\n");
+      if(copy.result != 0) failed++;
+      printed++;
+   }
+   dprintf(fd, "%d transactions shown, %d failed\n", printed, failed);
+   return(printed);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_errs_dump() - print the bus error counters to fd, one    *
+ * line, with the failed attempts of each error class seen.     *
+ * Returns the number of transactions given up, -1 if no bno.   *
+ * ------------------------------------------------------------ */
+int bno_errs_dump(bno055_t *bno, int fd) {
+   if(bno == NULL) return(-1);
+   const struct bnoerrs *e = &bno->errs;
+   int c;
+
+   dprintf(fd, "Bus errors of %s@0x%02X: %lu retries, %lu recovered, %lu failed",
+               bno->bus.name, bno->addr, e->retries, e->recovered, e->failed);
+   for(c = BNO_E_NACK; c < BNO_E_CLASSES; c++) {
+      if(e->count[c] > 0) dprintf(fd, ", %s %lu", bno_errclass_name(c), e->count[c]);
+   }
+   if(e->last != BNO_E_OK) dprintf(fd, ", last %s", strerror(e->last_errno));
+   dprintf(fd, "\n");
+   return((int) e->failed);
+}
@@ -0,0 +1,564 @@
+/* ------------------------------------------------------------ *
+ * file:        out_bno055.c                                    *
+ * purpose:     Sample output formatters. One column table maps *
+ *              the struct bnosnap values to their names, HTML  *
+ *              labels and decimals, the text, CSV, JSON Lines, *
+ *              binary and HTML writers all walk it. Rows are   *
+ *              collected in a 64KB buffer and go out with one  *
+ *              write() per batch instead of one per line: when *
+ *              the buffer fills up, or BNO_OUT_LATENCY_MS after*
+ *              the last write. A terminal gets every line.     *
+ *              HTML files are replaced atomically, and in      *
+ *              continuous mode only rewritten on changes.      *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include "getbno055.h"
+
+#define OUT_ROWMAX 1024       // longest formatted row, all fields
+
+/* ------------------------------------------------------------ *
+ * Column table in BNO_F_ order. key names the CSV and JSON     *
+ * column, label the HTML cell (NULL = not shown), prec is the  *
+ * text/CSV/JSON and hprec the HTML decimals, -1 marks a signed *
+ * and -2 an unsigned byte value.                               *
+ * ------------------------------------------------------------ */
+struct outcol{
+   uint16_t field;            // BNO_F_ group of the column
+   const char *key;           // CSV and JSON column name
+   const char *label;         // HTML cell label
+   size_t off;                // value offset in struct bnosnap
+   signed char prec;          // decimals, -1/-2 = byte value
+   signed char hprec;         // HTML decimals
+};
+
+#define COL_D(f, key, label, m, p, hp) { f, key, label, offsetof(struct bnosnap, m), p, hp }
+#define COL_C(f, key, label, m) { f, key, label, offsetof(struct bnosnap, m), -1, -1 }
+#define COL_U(f, key, label, m) { f, key, label, offsetof(struct bnosnap, m), -2, -2 }
+
+static const struct outcol out_cols[] = {
+   COL_D(BNO_F_ACC, "acc_x", "Accelerometer X", acc.adata_x, 2, 2),
+   COL_D(BNO_F_ACC, "acc_y", "Accelerometer Y", acc.adata_y, 2, 2),
+   COL_D(BNO_F_ACC, "acc_z", "Accelerometer Z", acc.adata_z, 2, 2),
+   COL_D(BNO_F_MAG, "mag_x", "Magnetometer X", mag.mdata_x, 2, 2),
+   COL_D(BNO_F_MAG, "mag_y", "Magnetometer Y", mag.mdata_y, 2, 2),
+   COL_D(BNO_F_MAG, "mag_z", "Magnetometer Z", mag.mdata_z, 2, 2),
+   COL_D(BNO_F_GYR, "gyr_x", "Gyroscope X", gyr.gdata_x, 2, 2),
+   COL_D(BNO_F_GYR, "gyr_y", "Gyroscope Y", gyr.gdata_y, 2, 2),
+   COL_D(BNO_F_GYR, "gyr_z", "Gyroscope Z", gyr.gdata_z, 2, 2),
+   COL_D(BNO_F_EUL, "eul_head", "Euler Heading", eul.eul_head, 4, 6),
+   COL_D(BNO_F_EUL, "eul_roll", "Euler Roll", eul.eul_roll, 4, 6),
+   COL_D(BNO_F_EUL, "eul_pitch", "Euler Pitch", eul.eul_pitc, 4, 6),
+   COL_D(BNO_F_QUA, "qua_w", "Quaternation W", qua.quater_w, 2, 2),
+   COL_D(BNO_F_QUA, "qua_x", "Quaternation X", qua.quater_x, 2, 2),
+   COL_D(BNO_F_QUA, "qua_y", "Quaternation Y", qua.quater_y, 2, 2),
+   COL_D(BNO_F_QUA, "qua_z", "Quaternation Z", qua.quater_z, 2, 2),
+   COL_D(BNO_F_LIN, "lin_x", "Linear Acceleration X", lin.linacc_x, 2, 2),
+   COL_D(BNO_F_LIN, "lin_y", "Linear Acceleration Y", lin.linacc_y, 2, 2),
+   COL_D(BNO_F_LIN, "lin_z", "Linear Acceleration Z", lin.linacc_z, 2, 2),
+   COL_D(BNO_F_GRA, "gra_x", "Gravity Vector X", gra.gravityx, 2, 2),
+   COL_D(BNO_F_GRA, "gra_y", "Gravity Vector Y", gra.gravityy, 2, 2),
+   COL_D(BNO_F_GRA, "gra_z", "Gravity Vector Z", gra.gravityz, 2, 2),
+   COL_C(BNO_F_STAT, "temp", "Temperature", temp_val),
+   COL_U(BNO_F_STAT, "sys_cal", "System Calibration", scal_st),
+   COL_U(BNO_F_STAT, "gyr_cal", "Gyroscope Calibration", gcal_st),
+   COL_U(BNO_F_STAT, "acc_cal", "Accelerometer Calibration", acal_st),
+   COL_U(BNO_F_STAT, "mag_cal", "Magnetometer Calibration", mcal_st),
+   COL_U(BNO_F_STAT, "sys_stat", NULL, sys_stat),
+   COL_U(BNO_F_STAT, "sys_err", NULL, sys_err),
+   COL_U(BNO_F_STAT, "unit_sel", NULL, unitsel)
+};
+#define OUT_NCOLS (int)(sizeof(out_cols) / sizeof(out_cols[0]))
+
+/* ------------------------------------------------------------ *
+ * Text line tags of the BNO_F_ groups, the "-t" output format  *
+ * ------------------------------------------------------------ */
+#define OUT_TAG(f, F, ...) #F,
+static const char *out_tags[] = { BNO_VECTORS(OUT_TAG) NULL };
+
+static const char *out_names[] = { "text", "csv", "json", "bin" };
+
+struct bnoout{
+   int fd;                    // destination, stdout or a pipe
+   int format;                // BNO_OUT_ format
+   uint16_t fields;           // BNO_F_ mask, plus BNO_OUT_HEAD
+   int tty;                   // fd is a terminal, write every row
+   long rows;                 // rows formatted so far
+   int64_t flushed_ns;        // time of the last write
+   int len;                   // bytes in buf
+   char buf[BNO_OUT_BUFSIZE];
+};
+
+static int64_t out_now() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------ *
+ * out_put() - append printf() formatted text to the buffer,    *
+ * bno_out_sample() leaves OUT_ROWMAX bytes room for a row      *
+ * ------------------------------------------------------------ */
+static void out_put(struct bnoout *out, const char *fmt, ...) {
+   va_list ap;
+   int room = BNO_OUT_BUFSIZE - out->len;
+   va_start(ap, fmt);
+   int n = vsnprintf(out->buf + out->len, room, fmt, ap);
+   va_end(ap);
+   if(n > 0) out->len += (n < room) ? n : room - 1;
+}
+
+/* ------------------------------------------------------------ *
+ * out_str() - append a plain string, no format parsing         *
+ * ------------------------------------------------------------ */
+static void out_str(struct bnoout *out, const char *str) {
+   int n = strlen(str);
+   if(n >= BNO_OUT_BUFSIZE - out->len) n = BNO_OUT_BUFSIZE - out->len - 1;
+   memcpy(out->buf + out->len, str, n);
+   out->len += n;
+}
+
+/* ------------------------------------------------------------ *
+ * out_fixed() - v with prec decimals, the same digits as "%.*f"*
+ * printf() rounds the exact binary value half to even. Far from*
+ * a tie, rounding v * 10^prec gives that result; values near a *
+ * tie, huge values and NaN/Inf go through printf() itself.     *
+ * ------------------------------------------------------------ */
+static void out_fixed(struct bnoout *out, double v, int prec) {
+   static const double pow10[] = { 1, 10, 100, 1e3, 1e4, 1e5, 1e6 };
+   double a = fabs(v);
+   if(prec > 6 || !(a < 1e12)) {
+      out_put(out, "%.*f", prec, v);
+      return;
+   }
+   double x = a * pow10[prec];
+   double f = x - floor(x);
+   if(fabs(f - 0.5) < 1e-6) {
+      out_put(out, "%.*f", prec, v);
+      return;
+   }
+   uint64_t r = (uint64_t)(x + 0.5);
+
+   char tmp[32];
+   char *p = tmp + sizeof(tmp);
+   int i;
+   for(i = 0; i < prec; i++) {
+      *--p = '0' + r % 10;
+      r /= 10;
+   }
+   if(prec > 0) *--p = '.';
+   do {
+      *--p = '0' + r % 10;
+      r /= 10;
+   } while(r > 0);
+   if(signbit(v)) *--p = '-';                 // "-0.00" like printf()
+   memcpy(out->buf + out->len, p, tmp + sizeof(tmp) - p);
+   out->len += tmp + sizeof(tmp) - p;
+}
+
+/* ------------------------------------------------------------ *
+ * out_value() - column c of d, with prec decimals              *
+ * ------------------------------------------------------------ */
+static void out_value(struct bnoout *out, const struct bnosnap *d, const struct outcol *c, int prec) {
+   const char *p = (const char *) d + c->off;
+   if(c->prec == -1) out_fixed(out, *(const signed char *) p, 0);
+   else if(c->prec == -2) out_fixed(out, *(const unsigned char *) p, 0);
+   else {
+      double v;
+      memcpy(&v, p, sizeof(v));
+      out_fixed(out, v, prec);
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * out_text() - the "-t" lines: each group is its tag and the   *
+ * values. With BNO_OUT_HEAD it is one line per sample, led by  *
+ * the sensor index, time and transfer time, else one per group.*
+ * ------------------------------------------------------------ */
+static void out_text(struct bnoout *out, const struct bnosample *smp) {
+   const struct bnosnap *d = &smp->snap;
+   int head = (out->fields & BNO_OUT_HEAD) != 0;
+   int i, g;
+
+   if(head) out_put(out, "S%d %lld.%06ld XFR %ld ", smp->sensor, (long long) d->ts.tstamp.tv_sec,
+                    d->ts.tstamp.tv_nsec / 1000, d->ts.xfer_ns / 1000);
+   for(g = 0; out_tags[g] != NULL; g++) {
+      if(!(out->fields & (1 << g))) continue;
+      out_str(out, out_tags[g]);
+      for(i = 0; i < OUT_NCOLS; i++) {
+         if(out_cols[i].field != (1 << g)) continue;
+         out_str(out, " ");
+         out_value(out, d, &out_cols[i], out_cols[i].prec);
+      }
+      out_str(out, head ? " " : "\n");
+   }
+   if(out->fields & BNO_F_STAT) {
+      out_put(out, "TMP %d%c", d->temp_val, ((d->unitsel >> 4) & 0x01) ? 'F' : 'C');
+      out_str(out, head ? " " : "\n");
+      out_put(out, "CAL [S:%d G:%d A:%d M:%d]", d->scal_st, d->gcal_st, d->acal_st, d->mcal_st);
+      out_str(out, head ? " " : "\n");
+   }
+   if(head) out->buf[out->len - 1] = '\n';
+}
+
+/* ------------------------------------------------------------ *
+ * out_csv() - comma separated, the column names in a first row *
+ * ------------------------------------------------------------ */
+static void out_csv(struct bnoout *out, const struct bnosample *smp) {
+   const struct bnosnap *d = &smp->snap;
+   int head = (out->fields & BNO_OUT_HEAD) != 0;
+   const char *sep = "";
+   int i;
+
+   if(out->rows == 0) {
+      if(head) {
+         out_put(out, "sensor,time,xfer_us");
+         sep = ",";
+      }
+      for(i = 0; i < OUT_NCOLS; i++) {
+         if(!(out->fields & out_cols[i].field)) continue;
+         out_put(out, "%s%s", sep, out_cols[i].key);
+         sep = ",";
+      }
+      out_put(out, "\n");
+      sep = "";
+   }
+   if(head) {
+      out_put(out, "%d,%lld.%09ld,%ld", smp->sensor, (long long) d->ts.tstamp.tv_sec,
+              d->ts.tstamp.tv_nsec, d->ts.xfer_ns / 1000);
+      sep = ",";
+   }
+   for(i = 0; i < OUT_NCOLS; i++) {
+      if(!(out->fields & out_cols[i].field)) continue;
+      out_str(out, sep);
+      out_value(out, d, &out_cols[i], out_cols[i].prec);
+      sep = ",";
+   }
+   out_str(out, "\n");
+}
+
+/* ------------------------------------------------------------ *
+ * out_json() - JSON Lines, one object per sample               *
+ * ------------------------------------------------------------ */
+static void out_json(struct bnoout *out, const struct bnosample *smp) {
+   const struct bnosnap *d = &smp->snap;
+   const char *sep = "";
+   int i;
+
+   out_str(out, "{");
+   if(out->fields & BNO_OUT_HEAD) {
+      out_put(out, "\"sensor\":%d,\"time\":%lld.%09ld,\"xfer_us\":%ld", smp->sensor,
+              (long long) d->ts.tstamp.tv_sec, d->ts.tstamp.tv_nsec, d->ts.xfer_ns / 1000);
+      sep = ",";
+   }
+   for(i = 0; i < OUT_NCOLS; i++) {
+      if(!(out->fields & out_cols[i].field)) continue;
+      out_str(out, sep);
+      out_str(out, "\"");
+      out_str(out, out_cols[i].key);
+      out_str(out, "\":");
+      out_value(out, d, &out_cols[i], out_cols[i].prec);
+      sep = ",";
+   }
+   out_str(out, "}\n");
+}
+
+/* ------------------------------------------------------------ *
+ * out_bin() - bno055d frames, readable with bno_frame_decode() *
+ * the frame counter numbers the rows                           *
+ * ------------------------------------------------------------ */
+static void out_bin(struct bnoout *out, const struct bnosample *smp) {
+   unsigned char *p = (unsigned char *) out->buf + out->len;
+   struct bnoframe hdr;
+   int len = bno_frame_encode(smp, out->fields & BNO_F_ALL, p);
+   memcpy(&hdr, p, sizeof(hdr));
+   hdr.seq = out->rows;
+   memcpy(p, &hdr, sizeof(hdr));
+   out->len += len;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_format() - format number for a name, -1 if unknown   *
+ * ------------------------------------------------------------ */
+int bno_out_format(const char *name) {
+   int i;
+   for(i = 0; i < (int)(sizeof(out_names) / sizeof(out_names[0])); i++)
+      if(strcmp(name, out_names[i]) == 0) return(i);
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_open() - formatter for fd. fields is a BNO_F_ mask,  *
+ * with BNO_OUT_HEAD each row starts with sensor and time.      *
+ * ------------------------------------------------------------ */
+struct bnoout *bno_out_open(int fd, int format, uint16_t fields) {
+   if(format < BNO_OUT_TEXT || format > BNO_OUT_BIN) {
+      BNO_ERROR("Error: invalid output format %d.\n", format);
+      return(NULL);
+   }
+   struct bnoout *out = malloc(sizeof(struct bnoout));
+   if(out == NULL) {
+      BNO_ERROR("Error: cannot allocate the output buffer.\n");
+      return(NULL);
+   }
+   out->fd = fd;
+   out->format = format;
+   out->fields = fields;
+   out->tty = isatty(fd);
+   out->rows = 0;
+   out->flushed_ns = 0;
+   out->len = 0;
+   return(out);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_flush() - write the buffered rows. Earlier stdio     *
+ * output to the same fd goes first, so lines keep their order. *
+ * ------------------------------------------------------------ */
+int bno_out_flush(struct bnoout *out) {
+   int done = 0;
+   if(out->fd == STDOUT_FILENO) fflush(stdout);
+   while(done < out->len) {
+      ssize_t n = write(out->fd, out->buf + done, out->len - done);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) {
+         BNO_ERROR("Error: cannot write the output, %s.\n", strerror(errno));
+         out->len = 0;
+         return(-1);
+      }
+      done += n;
+   }
+   out->len = 0;
+   out->flushed_ns = out_now();
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_sample() - format one sample into the buffer, write  *
+ * when it is full, or the oldest row waits BNO_OUT_LATENCY_MS. *
+ * ------------------------------------------------------------ */
+int bno_out_sample(struct bnoout *out, const struct bnosample *smp) {
+   if(out->len > BNO_OUT_BUFSIZE - OUT_ROWMAX && bno_out_flush(out) != 0) return(-1);
+   switch(out->format) {
+      case BNO_OUT_TEXT: out_text(out, smp); break;
+      case BNO_OUT_CSV:  out_csv(out, smp); break;
+      case BNO_OUT_JSON: out_json(out, smp); break;
+      case BNO_OUT_BIN:  out_bin(out, smp); break;
+   }
+   out->rows++;
+   if(out->tty || out_now() - out->flushed_ns >= BNO_OUT_LATENCY_MS * 1000000LL)
+      return(bno_out_flush(out));
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_close() - write what is left, free the formatter     *
+ * ------------------------------------------------------------ */
+int bno_out_close(struct bnoout *out) {
+   if(out == NULL) return(0);
+   int res = bno_out_flush(out);
+   free(out);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * out_html() - render the fields of d as HTML table into out   *
+ * ------------------------------------------------------------ */
+static void out_html(struct bnoout *out, const struct bnosnap *d, uint16_t fields) {
+   const char *sep = "";
+   int i;
+   out->len = 0;
+   out_str(out, "<table><tr>\n");
+   for(i = 0; i < OUT_NCOLS; i++) {
+      if(!(fields & out_cols[i].field) || out_cols[i].label == NULL) continue;
+      out_put(out, "%s<td class=\"sensordata\">%s:<span class=\"sensorvalue\">", sep, out_cols[i].label);
+      out_value(out, d, &out_cols[i], out_cols[i].hprec);
+      out_str(out, "</span></td>\n");
+      sep = "<td class=\"sensorspace\"></td>\n";
+   }
+   out_str(out, "</tr></table>\n");
+}
+
+/* ------------------------------------------------------------ *
+ * out_replace() - write len bytes of buf as the new content of *
+ * file: into "<file>.tmp" first, then rename() it over file. A *
+ * web server reading file sees the old or the new page, never  *
+ * a truncated one. The temp file is in the same directory, so  *
+ * the rename stays on one file system.                         *
+ * ------------------------------------------------------------ */
+static int out_replace(const char *file, const char *buf, int len) {
+   char tmp[PATH_MAX];
+   if(snprintf(tmp, sizeof(tmp), "%s.tmp", file) >= (int) sizeof(tmp)) {
+      BNO_ERROR("Error: file name too long [%s].\n", file);
+      return(-1);
+   }
+   int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+   if(fd < 0) {
+      BNO_ERROR("Error open %s for writing.\n", tmp);
+      return(-1);
+   }
+   int done = 0;
+   while(done < len) {
+      ssize_t n = write(fd, buf + done, len - done);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) break;
+      done += n;
+   }
+   if(close(fd) != 0 || done < len || rename(tmp, file) != 0) {
+      BNO_ERROR("Error: cannot write %s, %s.\n", file, strerror(errno));
+      unlink(tmp);
+      return(-1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_out_html() - write the fields of d as HTML table to file *
+ * ------------------------------------------------------------ */
+int bno_out_html(const char *file, const struct bnosnap *d, uint16_t fields) {
+   struct bnoout *out = bno_out_open(-1, BNO_OUT_TEXT, fields);
+   if(out == NULL) return(-1);
+   out_html(out, d, fields);
+   int res = out_replace(file, out->buf, out->len);
+   free(out);
+   return(res);
+}
+
+/* ------------------------------------------------------------ *
+ * Change-driven HTML file updates for continuous sampling. The *
+ * file is only rewritten if a value moved by more than the     *
+ * deadband since the page on disk was made, and the page text  *
+ * differs, at most maxhz times per second. A change held back  *
+ * by the rate limit is written by a later update or the close. *
+ * ------------------------------------------------------------ */
+struct bnohtml{
+   char file[PATH_MAX];       // HTML file
+   uint16_t fields;           // BNO_F_ mask of the table
+   double deadband;           // min value change, 0 = any change
+   int64_t period_ns;         // min time between writes, 0 = none
+   int64_t written_ns;        // time of the last write
+   int verbose;
+   long writes;               // file writes
+   long skipped;              // updates without a write
+   int shown;                 // page holds the file content
+   int held;                  // held holds a change not written yet
+   struct bnosnap last;       // values of the page on disk
+   struct bnosnap pending;    // newest change held back by the limit
+   struct bnoout *page;       // page on disk
+   struct bnoout *next;       // page being rendered
+};
+
+/* ------------------------------------------------------------ *
+ * bno_html_open() - writer for file, fields is a BNO_F_ mask,  *
+ * deadband in the data units, maxhz the write limit, 0 = none  *
+ * ------------------------------------------------------------ */
+struct bnohtml *bno_html_open(const char *file, uint16_t fields, double deadband, double maxhz, int verbose) {
+   if(strlen(file) >= PATH_MAX || deadband < 0 || maxhz < 0) {
+      BNO_ERROR("Error: invalid HTML file settings.\n");
+      return(NULL);
+   }
+   struct bnohtml *h = calloc(1, sizeof(struct bnohtml));
+   if(h == NULL) return(NULL);
+   h->page = bno_out_open(-1, BNO_OUT_TEXT, fields);
+   h->next = bno_out_open(-1, BNO_OUT_TEXT, fields);
+   if(h->page == NULL || h->next == NULL) {
+      free(h->page);
+      free(h->next);
+      free(h);
+      return(NULL);
+   }
+   strcpy(h->file, file);
+   h->fields = fields;
+   h->deadband = deadband;
+   h->period_ns = maxhz > 0 ? (int64_t)(1e9 / maxhz) : 0;
+   h->verbose = verbose;
+   return(h);
+}
+
+/* ------------------------------------------------------------ *
+ * html_moved() - 1 if a table value of d left the deadband     *
+ * around the values on disk. Status bytes count on any change. *
+ * ------------------------------------------------------------ */
+static int html_moved(struct bnohtml *h, const struct bnosnap *d) {
+   int i;
+   for(i = 0; i < OUT_NCOLS; i++) {
+      const struct outcol *c = &out_cols[i];
+      if(!(h->fields & c->field) || c->label == NULL) continue;
+      const char *now = (const char *) d + c->off;
+      const char *was = (const char *) &h->last + c->off;
+      if(c->prec < 0) {
+         if(*now != *was) return(1);
+         continue;
+      }
+      double a, b;
+      memcpy(&a, now, sizeof(a));
+      memcpy(&b, was, sizeof(b));
+      if(fabs(a - b) > h->deadband) return(1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_html_update() - new data for the page. Returns 1 if the  *
+ * file was written, 0 if not needed or held back, -1 on errors.*
+ * ------------------------------------------------------------ */
+int bno_html_update(struct bnohtml *h, const struct bnosnap *d) {
+   if(h->shown && !html_moved(h, d)) {
+      h->skipped++;
+      return(0);
+   }
+   out_html(h->next, d, h->fields);
+   if(h->shown && h->next->len == h->page->len
+      && memcmp(h->next->buf, h->page->buf, h->page->len) == 0) {
+      h->skipped++;
+      return(0);
+   }
+   int64_t now = out_now();
+   if(h->shown && now - h->written_ns < h->period_ns) {
+      if(d != &h->pending) h->pending = *d;
+      h->held = 1;
+      h->skipped++;
+      return(0);
+   }
+   if(out_replace(h->file, h->next->buf, h->next->len) != 0) return(-1);
+
+   struct bnoout *tmp = h->page;
+   h->page = h->next;
+   h->next = tmp;
+   h->last = *d;
+   h->shown = 1;
+   h->held = 0;
+   h->written_ns = now;
+   h->writes++;
+   return(1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_html_close() - write a change the rate limit held back,  *
+ * then free the writer                                         *
+ * ------------------------------------------------------------ */
+int bno_html_close(struct bnohtml *h) {
+   if(h == NULL) return(0);
+   int res = 0;
+   if(h->held) {
+      h->period_ns = 0;
+      if(bno_html_update(h, &h->pending) < 0) res = -1;
+   }
+   BNO_DEBUG(h->verbose, "Debug: HTML file %s written %ld times, %ld updates skipped\n",
+                              h->file, h->writes, h->skipped);
+   free(h->page);
+   free(h->next);
+   free(h);
+   return(res);
+}
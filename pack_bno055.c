@@ -0,0 +1,197 @@
+/* ------------------------------------------------------------ *
+ * file:        pack_bno055.c                                   *
+ * purpose:     Streaming delta + varint codec for capture      *
+ *              records. Each int16 channel is stored as the    *
+ *              zig-zag varint of its change since the previous *
+ *              sample of the same sensor. A mask byte flags the*
+ *              vectors (acc, mag, ... gravity) and the status  *
+ *              bytes that changed, only those are stored. The  *
+ *              sample time is coded as the change of the       *
+ *              sampling interval. The first record of a sensor *
+ *              after bno_pack_reset() is a keyframe, coded     *
+ *              against zero, so decoding can start at every    *
+ *              reset point.                                    *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "getbno055.h"
+
+#define PACK_WORDS  ((BNO055_TEMP_ADDR - SNAPSHOT_START) / 2)  // int16 channels 0x08..0x33
+#define PACK_STATUS (SNAPSHOT_BYTECOUNT - PACK_WORDS * 2)      // status bytes 0x34..0x3B
+
+_Static_assert(PACK_STATUS <= 8, "status change mask is one byte");
+
+/* ------------------------------------------------------------ *
+ * Channel groups that update together: acc, mag, gyr, euler,   *
+ * quaternion, linear acc, gravity. Bit 7 of the group mask is  *
+ * the status bytes. pack_group[g] is the first int16 of g.     *
+ * ------------------------------------------------------------ */
+#define PACK_GROUPS 7
+static const unsigned char pack_group[PACK_GROUPS + 1] = { 0, 3, 6, 9, 12, 16, 19, 22 };
+_Static_assert(PACK_WORDS == 22, "channel groups do not match the snapshot");
+
+/* ------------------------------------------------------------ *
+ * put_varint()/get_varint() - 7 bits per byte, low bits first, *
+ * bit 7 set if more bytes follow                               *
+ * ------------------------------------------------------------ */
+static unsigned char *put_varint(unsigned char *p, uint64_t v) {
+   while(v >= 0x80) {
+      *p++ = (v & 0x7F) | 0x80;
+      v >>= 7;
+   }
+   *p++ = v;
+   return(p);
+}
+
+static const unsigned char *get_varint(const unsigned char *p, const unsigned char *end, uint64_t *v) {
+   int shift;
+   *v = 0;
+   for(shift = 0; p < end && shift < 64; shift += 7) {
+      *v |= (uint64_t)(*p & 0x7F) << shift;
+      if((*p++ & 0x80) == 0) return(p);
+   }
+   return(NULL);                       // truncated or too long
+}
+
+/* ------------------------------------------------------------ *
+ * zig-zag: small negative and positive changes both become     *
+ * small unsigned numbers, -1 -> 1, 1 -> 2, -2 -> 3 ...         *
+ * ------------------------------------------------------------ */
+static uint64_t zz_enc(int64_t v) {
+   return ((uint64_t) v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t zz_dec(uint64_t v) {
+   return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_pack_reset() - start a new keyframe block: forget the    *
+ * previous samples, times are coded against base_ns. Encoder   *
+ * and decoder reset at the same records.                       *
+ * ------------------------------------------------------------ */
+void bno_pack_reset(struct bnopack *pk, int64_t base_ns) {
+   memset(pk, 0, sizeof(struct bnopack));
+   pk->base_ns = base_ns;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_pack_rec() - encode a data record into out, which needs  *
+ * BNO_PACK_RECMAX bytes. Returns the encoded length, or -1 for *
+ * a bad sensor index.                                          *
+ * ------------------------------------------------------------ */
+int bno_pack_rec(struct bnopack *pk, const struct bnorec *rec, unsigned char *out) {
+   int s = rec->sensor;
+   if(s >= BNO_ACQ_MAX) return(-1);
+   unsigned char *p = out;
+   uint8_t *prev = pk->reg[s];
+   int i;
+
+   *p++ = s;
+   if(pk->seen[s]) {
+      int64_t dt = rec->tstamp_ns - pk->tstamp[s];
+      p = put_varint(p, zz_enc(dt - pk->dt[s]));
+      pk->dt[s] = dt;
+   }
+   else {
+      p = put_varint(p, zz_enc(rec->tstamp_ns - pk->base_ns));
+      pk->dt[s] = 0;
+      memset(prev, 0, SNAPSHOT_BYTECOUNT);
+      pk->seen[s] = 1;
+   }
+   pk->tstamp[s] = rec->tstamp_ns;
+   p = put_varint(p, rec->xfer_us);
+
+   unsigned char *groups = p++;
+   int g;
+   *groups = 0;
+   for(g = 0; g < PACK_GROUPS; g++) {
+      int from = 2 * pack_group[g], len = 2 * (pack_group[g+1] - pack_group[g]);
+      if(memcmp(&rec->reg[from], &prev[from], len) == 0) continue;
+      *groups |= 1 << g;
+      for(i = pack_group[g]; i < pack_group[g+1]; i++) {
+         int16_t now  = (int16_t)(rec->reg[2*i] | (rec->reg[2*i+1] << 8));
+         int16_t last = (int16_t)(prev[2*i] | (prev[2*i+1] << 8));
+         p = put_varint(p, zz_enc((int16_t)(now - last)));
+      }
+   }
+
+   if(memcmp(&rec->reg[2*PACK_WORDS], &prev[2*PACK_WORDS], PACK_STATUS) != 0) {
+      unsigned char *mask = p++;
+      *groups |= 0x80;
+      *mask = 0;
+      for(i = 0; i < PACK_STATUS; i++) {
+         if(rec->reg[2*PACK_WORDS + i] != prev[2*PACK_WORDS + i]) {
+            *mask |= 1 << i;
+            *p++ = rec->reg[2*PACK_WORDS + i];
+         }
+      }
+   }
+   memcpy(prev, rec->reg, SNAPSHOT_BYTECOUNT);
+   return(p - out);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_unpack_rec() - decode the next record from in, len bytes *
+ * available. Returns the bytes used, or -1 if the data is      *
+ * truncated or invalid.                                        *
+ * ------------------------------------------------------------ */
+int bno_unpack_rec(struct bnopack *pk, const unsigned char *in, int len, struct bnorec *rec) {
+   const unsigned char *p = in, *end = in + len;
+   uint64_t v;
+   int i;
+
+   if(len < 1 || *p >= BNO_ACQ_MAX) return(-1);
+   int s = *p++;
+   uint8_t *prev = pk->reg[s];
+
+   memset(rec, 0, sizeof(struct bnorec));
+   rec->type   = BNO_REC_DATA;
+   rec->sensor = s;
+
+   if((p = get_varint(p, end, &v)) == NULL) return(-1);
+   if(pk->seen[s]) {
+      pk->dt[s] += zz_dec(v);
+      rec->tstamp_ns = pk->tstamp[s] + pk->dt[s];
+   }
+   else {
+      rec->tstamp_ns = pk->base_ns + zz_dec(v);
+      pk->dt[s] = 0;
+      memset(prev, 0, SNAPSHOT_BYTECOUNT);
+      pk->seen[s] = 1;
+   }
+   pk->tstamp[s] = rec->tstamp_ns;
+   if((p = get_varint(p, end, &v)) == NULL) return(-1);
+   rec->xfer_us = v;
+
+   if(p >= end) return(-1);
+   unsigned char groups = *p++;
+   memcpy(rec->reg, prev, SNAPSHOT_BYTECOUNT);
+   int g;
+   for(g = 0; g < PACK_GROUPS; g++) {
+      if(!(groups & (1 << g))) continue;
+      for(i = pack_group[g]; i < pack_group[g+1]; i++) {
+         if((p = get_varint(p, end, &v)) == NULL) return(-1);
+         int16_t last = (int16_t)(prev[2*i] | (prev[2*i+1] << 8));
+         uint16_t now = (uint16_t)(last + (int16_t) zz_dec(v));
+         rec->reg[2*i]   = now & 0xFF;
+         rec->reg[2*i+1] = now >> 8;
+      }
+   }
+
+   if(groups & 0x80) {
+      if(p >= end) return(-1);
+      unsigned char mask = *p++;
+      for(i = 0; i < PACK_STATUS; i++) {
+         if(!(mask & (1 << i))) continue;
+         if(p >= end) return(-1);
+         rec->reg[2*PACK_WORDS + i] = *p++;
+      }
+   }
+   memcpy(prev, rec->reg, SNAPSHOT_BYTECOUNT);
+   return(p - in);
+}
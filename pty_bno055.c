@@ -0,0 +1,242 @@
+/* ------------------------------------------------------------ *
+ * file:        pty_bno055.c                                    *
+ * purpose:     Pseudo-terminal stand-in for a BNO055 in UART   *
+ *              mode. A responder thread sits on the master     *
+ *              side of a pty, parses the AA request frames,    *
+ *              runs them against the simulated sensor and      *
+ *              answers with BB or EE frames, paced at 115200   *
+ *              baud wire time. The UART transport opens the    *
+ *              slave side like any serial port, so its         *
+ *              framing, pipelining and error recovery run      *
+ *              without hardware. Selected with the bus name    *
+ *              "uart:sim". "uart:sim:<ppm>" also answers that  *
+ *              many of a million requests with a bus over-run  *
+ *              status, a garbled frame, an empty EE 00 status  *
+ *              or a read/write fail status.                    *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#define _GNU_SOURCE           // ptsname_r()
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "getbno055.h"
+
+#define PTY_BYTE_NS         86806  // 10 bits at 115200 baud
+#define PTY_CHUNK           16     // bytes written per pacing step
+#define PTY_POLL_MS         50     // stop flag check interval
+
+struct bnopty{
+   int  master;                        // pty master fd, the "sensor" side
+   char name[64];                      // slave tty path
+   pthread_t thread;                   // responder thread
+   int  stop;                          // end the responder, atomic
+   struct bnotransport sim;            // simulated sensor behind it
+   long fault_ppm;                     // injected faults per million requests
+   unsigned int seed;                  // rand_r() state of the injection
+   unsigned long requests;             // request frames answered
+   unsigned long faults;               // of them with an injected fault
+   int  verbose;                       // debug flag
+};
+
+/* ------------------------------------------------------------ *
+ * pty_recv() - read exactly len bytes from the master side, 0  *
+ * on success, -1 if the responder was stopped or the pty broke *
+ * ------------------------------------------------------------ */
+static int pty_recv(struct bnopty *p, unsigned char *buf, int len) {
+   int got = 0;
+   while(got < len) {
+      if(__atomic_load_n(&p->stop, __ATOMIC_ACQUIRE)) return(-1);
+      struct pollfd pfd = { p->master, POLLIN, 0 };
+      int res = poll(&pfd, 1, PTY_POLL_MS);
+      if(res < 0 && errno != EINTR) return(-1);
+      if(res <= 0) continue;
+      ssize_t n = read(p->master, buf + got, len - got);
+      if(n < 0 && (errno == EINTR || errno == EAGAIN)) continue;
+      if(n <= 0) return(-1);
+      got += n;
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * pty_send() - write a response in PTY_CHUNK byte pieces, each *
+ * after its wire time, so the reader sees bytes trickle in as  *
+ * from a real 115200 baud line                                 *
+ * ------------------------------------------------------------ */
+static void pty_send(struct bnopty *p, const unsigned char *buf, int len) {
+   int sent = 0;
+   while(sent < len) {
+      int chunk = len - sent;
+      if(chunk > PTY_CHUNK) chunk = PTY_CHUNK;
+      long ns = (long) chunk * PTY_BYTE_NS;
+      struct timespec ts = { ns / 1000000000L, ns % 1000000000L };
+      nanosleep(&ts, NULL);
+      ssize_t n = write(p->master, buf + sent, chunk);
+      if(n < 0 && errno == EINTR) continue;
+      if(n <= 0) return;
+      sent += n;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * pty_fault() - answer a request with an injected fault: 1 is  *
+ * a bus over-run status the transport resends after, 2 a read  *
+ * frame with the wrong length, trailing bytes and all, 3 an    *
+ * EE 00 status that is neither success nor an error code, 4 a  *
+ * READ_FAIL or WRITE_FAIL status the transport gives up on.    *
+ * Returns 0 if the request should be answered normally.        *
+ * ------------------------------------------------------------ */
+static int pty_fault(struct bnopty *p, int len, int wr) {
+   if(p->fault_ppm <= 0 || rand_r(&p->seed) % 1000000 >= p->fault_ppm) return(0);
+   unsigned char resp[2 + 256];
+   int kind = 1 + rand_r(&p->seed) % 4;
+   p->faults++;
+
+   switch(kind) {
+      case 1:
+         resp[0] = 0xEE;
+         resp[1] = 0x07;               // BUS_OVER_RUN_ERROR
+         pty_send(p, resp, 2);
+         break;
+      case 2:
+         resp[0] = 0xBB;
+         resp[1] = len + 1;            // one byte too many
+         memset(&resp[2], 0x5A, len + 1);
+         pty_send(p, resp, len + 3);
+         break;
+      case 3:
+         resp[0] = 0xEE;
+         resp[1] = 0x00;
+         pty_send(p, resp, 2);
+         break;
+      default:
+         resp[0] = 0xEE;
+         resp[1] = wr ? 0x03 : 0x02;   // WRITE_FAIL, READ_FAIL
+         pty_send(p, resp, 2);
+         break;
+   }
+   return(kind);
+}
+
+/* ------------------------------------------------------------ *
+ * pty_thread() - the responder: read a request frame, run it   *
+ * on the simulated sensor, answer. While the sensor boots it   *
+ * stays silent, like the chip, and the transport times out.    *
+ * ------------------------------------------------------------ */
+static void *pty_thread(void *arg) {
+   struct bnopty *p = arg;
+   unsigned char hdr[4], data[256], resp[2 + 256];
+
+   for(;;) {
+      if(pty_recv(p, hdr, 1) != 0) break;
+      if(hdr[0] != 0xAA) {
+         resp[0] = 0xEE;
+         resp[1] = 0x06;               // WRONG_START_BYTE
+         pty_send(p, resp, 2);
+         continue;
+      }
+      if(pty_recv(p, &hdr[1], 3) != 0) break;
+      int wr = hdr[1] == 0x00;
+      int len = hdr[3];
+      if(wr && pty_recv(p, data, len) != 0) break;
+      p->requests++;
+
+      if(hdr[1] > 0x01) {
+         resp[0] = 0xEE;
+         resp[1] = 0x06;
+         pty_send(p, resp, 2);
+         continue;
+      }
+      if(len == 0) {
+         resp[0] = 0xEE;
+         resp[1] = 0x09;               // MIN_LENGTH_ERROR
+         pty_send(p, resp, 2);
+         continue;
+      }
+      if(pty_fault(p, len, wr) != 0) continue;
+
+      if(wr) {
+         if(p->sim.write_regs(&p->sim, hdr[2], data, len) != 0) continue;
+         resp[0] = 0xEE;
+         resp[1] = 0x01;               // WRITE_SUCCESS
+         pty_send(p, resp, 2);
+      }
+      else {
+         if(p->sim.read_regs(&p->sim, hdr[2], &resp[2], len) != 0) continue;
+         resp[0] = 0xBB;
+         resp[1] = len;
+         pty_send(p, resp, 2 + len);
+      }
+   }
+   return(NULL);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_pty_open() - create the pty and start the responder for  *
+ * spec "sim" or "sim:<ppm>". The slave tty path comes from     *
+ * bno_pty_name(), open it with the UART transport.             *
+ * ------------------------------------------------------------ */
+struct bnopty *bno_pty_open(const char *spec, int verbose) {
+   struct bnopty *p = calloc(1, sizeof(struct bnopty));
+   if(p == NULL) return(NULL);
+   if(spec[3] == ':') p->fault_ppm = strtol(&spec[4], NULL, 10);
+   p->seed = 1;
+   p->verbose = verbose;
+
+   p->master = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+   if(p->master < 0 || grantpt(p->master) != 0 || unlockpt(p->master) != 0
+      || ptsname_r(p->master, p->name, sizeof(p->name)) != 0) {
+      BNO_ERROR("Error: cannot create a pseudo-terminal, %s\n", strerror(errno));
+      if(p->master >= 0) close(p->master);
+      free(p);
+      return(NULL);
+   }
+   struct termios tio;
+   if(tcgetattr(p->master, &tio) == 0) {
+      cfmakeraw(&tio);
+      tcsetattr(p->master, TCSANOW, &tio);
+   }
+
+   p->sim = bno_sim_transport;
+   p->sim.verbose = verbose;
+   if(p->sim.open(&p->sim, "sim", 0x28) != 0) {
+      close(p->master);
+      free(p);
+      return(NULL);
+   }
+   if(pthread_create(&p->thread, NULL, pty_thread, p) != 0) {
+      BNO_ERROR("Error: cannot start the pseudo-terminal responder.\n");
+      p->sim.close(&p->sim);
+      close(p->master);
+      free(p);
+      return(NULL);
+   }
+   BNO_DEBUG(verbose, "Debug: UART stand-in on [%s], fault rate [%ld ppm]\n", p->name, p->fault_ppm);
+   return(p);
+}
+
+const char *bno_pty_name(struct bnopty *p) {
+   return(p->name);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_pty_close() - stop the responder, close the simulator    *
+ * ------------------------------------------------------------ */
+void bno_pty_close(struct bnopty *p) {
+   if(p == NULL) return;
+   __atomic_store_n(&p->stop, 1, __ATOMIC_RELEASE);
+   pthread_join(p->thread, NULL);
+   BNO_DEBUG(p->verbose, "Debug: UART stand-in answered %lu requests, %lu with faults\n",
+             p->requests, p->faults);
+   p->sim.close(&p->sim);
+   close(p->master);
+   free(p);
+}
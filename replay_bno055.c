@@ -0,0 +1,241 @@
+/* ------------------------------------------------------------ *
+ * file:        replay_bno055.c                                 *
+ * purpose:     Replay bus transport. Serves the registers of a *
+ *              capture file (see cap_bno055.c) as if they were *
+ *              read from the sensor, so the get_ functions, the*
+ *              snapshot and acquisition code run unchanged on  *
+ *              recorded data. Selected with the bus name       *
+ *              "replay:<file>", which serves the records as    *
+ *              fast as they are read, or "replay-rt:<file>" to *
+ *              follow the recorded sample times. "#<n>" after  *
+ *              the file name picks sensor index n of the file, *
+ *              else the first sensor with the I2C address.     *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "getbno055.h"
+
+struct replaydev{
+   unsigned char page[2][REGISTERMAP_END + 1]; // register maps
+   struct bnocapfile *cf;  // mapped capture file
+   int sensor;             // sensor index replayed
+   int realtime;           // 1 = follow the recorded sample times
+   long slot;              // record slot in the data registers, -1 = none
+   uint64_t served;        // data registers read from this record
+   int64_t rec0_ns;        // sample time of the first record
+   int64_t t0;             // open time, replay time base (realtime)
+   int64_t period;         // recorded sample period, end detection
+   struct bnotime ts;      // recorded time of the current record
+};
+
+static int64_t replay_now() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------ *
+ * replay_next() - next data slot of the replayed sensor after  *
+ * slot, or -1 at the end of the capture                        *
+ * ------------------------------------------------------------ */
+static long replay_next(struct replaydev *rp, long slot) {
+   const struct bnorec *r;
+   while((r = bno_cap_rec(rp->cf, ++slot)) != NULL) {
+      if(r->type == BNO_REC_DATA && r->sensor == rp->sensor) return(slot);
+   }
+   return(-1);
+}
+
+/* ------------------------------------------------------------ *
+ * replay_load() - put record slot into the data registers      *
+ * ------------------------------------------------------------ */
+static void replay_load(struct replaydev *rp, long slot) {
+   const struct bnorec *r = bno_cap_rec(rp->cf, slot);
+   memcpy(&rp->page[0][SNAPSHOT_START], r->reg, SNAPSHOT_BYTECOUNT - 1);  // not UNIT_SEL
+   rp->ts.tstamp.tv_sec  = r->tstamp_ns / 1000000000LL;
+   rp->ts.tstamp.tv_nsec = r->tstamp_ns % 1000000000LL;
+   rp->ts.xfer_ns = (long) r->xfer_us * 1000;
+   rp->slot = slot;
+   rp->served = 0;
+}
+
+/* ------------------------------------------------------------ *
+ * replay_advance() - move to the record a read of len bytes at *
+ * reg should see. As fast as possible, a record is served once:*
+ * re-reading one of its data registers 0x08..0x33 moves to the *
+ * next one, status reads (calibration, errors) do not.         *
+ * In real time, the newest record due since the open is shown. *
+ * Returns -1 at the end of the capture.                        *
+ * ------------------------------------------------------------ */
+static int replay_advance(struct replaydev *rp, int reg, int len) {
+   int first = reg > SNAPSHOT_START ? reg : SNAPSHOT_START;
+   int last  = reg + len - 1 < BNO055_TEMP_ADDR - 1 ? reg + len - 1 : BNO055_TEMP_ADDR - 1;
+   if(first > last) return(0);        // status registers only
+
+   uint64_t mask = ((2ULL << (last - SNAPSHOT_START)) - 1) & ~((1ULL << (first - SNAPSHOT_START)) - 1);
+   long next;
+
+   if(rp->realtime) {
+      int64_t due = rp->rec0_ns + (replay_now() - rp->t0);
+      while((next = replay_next(rp, rp->slot)) >= 0 && bno_cap_rec(rp->cf, next)->tstamp_ns <= due)
+         replay_load(rp, next);
+      if(next < 0 && due > bno_cap_rec(rp->cf, rp->slot)->tstamp_ns + rp->period) return(-1);
+   }
+   else if(rp->served & mask) {
+      if((next = replay_next(rp, rp->slot)) < 0) return(-1);
+      replay_load(rp, next);
+   }
+   rp->served |= mask;
+   return(0);
+}
+
+static int replay_open(struct bnotransport *t, const char *bus, int addr) {
+   char file[256];
+   const char *name = strchr(bus, ':') + 1;
+   if(strlen(name) >= sizeof(file)) {
+      BNO_ERROR("Error: invalid replay file name [%s].\n", name);
+      return(-1);
+   }
+   strcpy(file, name);
+
+   int sensor = -1;
+   char *idx = strrchr(file, '#');
+   if(idx != NULL) {
+      *idx = '\0';
+      sensor = strtol(idx + 1, NULL, 10);
+   }
+
+   struct replaydev *rp = calloc(1, sizeof(struct replaydev));
+   if(rp == NULL) return(-1);
+   rp->realtime = (strncmp(bus, "replay-rt:", 10) == 0);
+   if((rp->cf = bno_cap_open(file)) == NULL) {
+      free(rp);
+      return(-1);
+   }
+   const struct bnocaphdr *h = bno_cap_header(rp->cf);
+
+   int i;
+   for(i = 0; sensor < 0 && i < (int) h->nsensors; i++)
+      if(h->sens[i].addr == addr) sensor = i;
+   if(sensor < 0 || sensor >= (int) h->nsensors) {
+      BNO_ERROR("Error: no sensor [0x%02X] in the capture %s.\n", addr, file);
+      bno_cap_unmap(rp->cf);
+      free(rp);
+      return(-1);
+   }
+   rp->sensor = sensor;
+   rp->period = h->rate_mhz > 0 ? (int64_t)(1e12 / h->rate_mhz) : 1000000000LL / BNO_FUSION_HZ;
+
+   /* --------------------------------------------------------- *
+    * The registers the captured records do not cover come from *
+    * the sensor setup in the header. The chip answers like the *
+    * sensor did at the start of the capture.                   *
+    * --------------------------------------------------------- */
+   const struct bnocapsens *s = &h->sens[sensor];
+   unsigned char *p0 = rp->page[0];
+   unsigned char *p1 = rp->page[1];
+   p0[BNO055_CHIP_ID_ADDR] = BNO055_ID;
+   p0[BNO055_UNIT_SEL_ADDR] = s->unit_sel;
+   p0[BNO055_OPR_MODE_ADDR] = s->opr_mode;
+   p0[BNO055_PWR_MODE_ADDR] = normal;
+   p0[BNO055_AXIS_MAP_CONFIG_ADDR] = s->axr_conf;
+   p0[BNO055_AXIS_MAP_SIGN_ADDR] = s->axr_sign;
+   p0[BNO055_CALIB_STAT_ADDR] = s->calib_st;
+   memcpy(&p0[BNO055_SIC_MATRIX_0_LSB_ADDR], s->calset, CALIB_BYTECOUNT);
+   p1[BNO055_PAGE_ID_ADDR] = 0x01;
+
+   rp->slot = replay_next(rp, -1);
+   if(rp->slot < 0) {
+      BNO_ERROR("Error: no samples of sensor %d in the capture %s.\n", sensor, file);
+      bno_cap_unmap(rp->cf);
+      free(rp);
+      return(-1);
+   }
+   replay_load(rp, rp->slot);
+   rp->rec0_ns = bno_cap_rec(rp->cf, rp->slot)->tstamp_ns;
+   rp->t0 = replay_now();
+   t->priv = rp;
+
+   BNO_DEBUG(t->verbose, "Debug: Replay of sensor %d [%s] from [%s], %s\n", sensor, s->bus, file,
+                              rp->realtime ? "real time" : "as fast as possible");
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * replay_read_regs() - at the end of the capture the read fails*
+ * with errno ENODATA, so callers can tell it from bus errors.  *
+ * ------------------------------------------------------------ */
+static int replay_read_regs(struct bnotransport *t, unsigned char reg, void *buf, int len) {
+   struct replaydev *rp = t->priv;
+   int pg = rp->page[0][BNO055_PAGE_ID_ADDR] & 0x01;
+
+   if(pg == 0 && replay_advance(rp, reg, len) != 0) {
+      BNO_DEBUG(t->verbose, "Debug: Replay reached the end of the capture\n");
+      errno = ENODATA;
+      return(-1);
+   }
+   unsigned char *out = buf;
+   int i;
+   for(i = 0; i < len; i++) {
+      int r = reg + i;         // register address auto-increment
+      out[i] = (r <= REGISTERMAP_END) ? rp->page[pg][r] : 0xFF;
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * replay_write_regs() - configuration writes are kept, so they *
+ * read back, but cannot change the recorded data. A reset is   *
+ * ignored, SYS_TRIGGER bits clear themselves.                  *
+ * ------------------------------------------------------------ */
+static int replay_write_regs(struct bnotransport *t, unsigned char reg, const void *buf, int len) {
+   struct replaydev *rp = t->priv;
+   const unsigned char *in = buf;
+   int i;
+   for(i = 0; i < len && reg + i <= REGISTERMAP_END; i++) {
+      int r = reg + i;
+      if(r == BNO055_PAGE_ID_ADDR) {
+         rp->page[0][r] = rp->page[1][r] = in[i] & 0x01;
+         continue;
+      }
+      int pg = rp->page[0][BNO055_PAGE_ID_ADDR] & 0x01;
+      if(pg == 0 && (r < BNO055_UNIT_SEL_ADDR || r == BNO055_SYS_TRIGGER_ADDR)) continue;
+      rp->page[pg][r] = in[i];
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * replay_stamp() - the recorded time of the current record     *
+ * replaces the bus transaction time                            *
+ * ------------------------------------------------------------ */
+static int replay_stamp(struct bnotransport *t, struct bnotime *ts) {
+   struct replaydev *rp = t->priv;
+   *ts = rp->ts;
+   return(0);
+}
+
+static void replay_close(struct bnotransport *t) {
+   struct replaydev *rp = t->priv;
+   bno_cap_unmap(rp->cf);
+   free(t->priv);
+   t->priv = NULL;
+}
+
+const struct bnotransport bno_replay_transport = {
+   "replay",
+   replay_open,
+   replay_read_regs,
+   NULL,
+   replay_write_regs,
+   replay_close,
+   NULL,
+   replay_stamp,
+   NULL
+};
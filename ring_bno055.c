@@ -0,0 +1,248 @@
+/* ------------------------------------------------------------ *
+ * file:        ring_bno055.c                                   *
+ * purpose:     Lock-free sample rings between acquisition and  *
+ *              consumers. Fixed size slots of struct bnosample,*
+ *              a producer never blocks: if the ring is full the*
+ *              new sample is dropped and counted as overrun.   *
+ *              SPSC rings use two index counters, MPSC rings a *
+ *              sequence number per slot so that several bus    *
+ *              workers can push at once. The consumer can wait *
+ *              on an eventfd, which is only written while it   *
+ *              sleeps, so the fast path stays syscall-free.    *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdint.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include "getbno055.h"
+
+#define RING_CACHELINE 64
+
+struct ringslot{
+   size_t seq;                         // MPSC: slot turn, unused for SPSC
+   struct bnosample smp;
+};
+
+/* ------------------------------------------------------------ *
+ * Ring state. Producer and consumer indexes sit on their own   *
+ * cache lines, so the two sides do not bounce one line.        *
+ * ------------------------------------------------------------ */
+struct bnoring{
+   unsigned mask;                      // slot count - 1
+   int  mpsc;                          // 1 = several producers
+   int  efd;                           // eventfd, wakes the consumer
+   struct ringslot *slot;
+
+   size_t head __attribute__((aligned(RING_CACHELINE)));  // producer index
+   unsigned long overruns;             // samples dropped, ring full
+
+   size_t tail __attribute__((aligned(RING_CACHELINE)));  // consumer index
+   int  waiting;                       // consumer sleeps on efd
+};
+
+/* ------------------------------------------------------------ *
+ * bno_ring_new() - create a ring of size slots, a power of 2.  *
+ * mpsc = 0 for a single producer thread, 1 for several.        *
+ * ------------------------------------------------------------ */
+struct bnoring *bno_ring_new(unsigned size, int mpsc) {
+   if(size < 2 || (size & (size - 1)) != 0) {
+      BNO_ERROR("Error: ring size %u is not a power of 2.\n", size);
+      return(NULL);
+   }
+   struct bnoring *r = aligned_alloc(RING_CACHELINE, sizeof(struct bnoring));
+   if(r == NULL) {
+      BNO_ERROR("Error: cannot allocate the sample ring.\n");
+      return(NULL);
+   }
+   memset(r, 0, sizeof(struct bnoring));
+   r->mask = size - 1;
+   r->mpsc = mpsc;
+
+   r->slot = calloc(size, sizeof(struct ringslot));
+   r->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+   if(r->slot == NULL || r->efd < 0) {
+      BNO_ERROR("Error: cannot allocate the sample ring.\n");
+      if(r->efd >= 0) close(r->efd);
+      free(r->slot);
+      free(r);
+      return(NULL);
+   }
+   unsigned i;
+   for(i = 0; i < size; i++) r->slot[i].seq = i;
+   return(r);
+}
+
+/* ------------------------------------------------------------ *
+ * ring_wake() - signal the consumer if it sleeps. The fence    *
+ * orders the published slot before the waiting check, paired  *
+ * with the one in bno_ring_read().                             *
+ * ------------------------------------------------------------ */
+static void ring_wake(struct bnoring *r) {
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if(__atomic_load_n(&r->waiting, __ATOMIC_RELAXED)) {
+      uint64_t one = 1;
+      if(write(r->efd, &one, sizeof(one)) != sizeof(one)) return;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * spsc_push() - the only producer owns head                    *
+ * ------------------------------------------------------------ */
+static int spsc_push(struct bnoring *r, const struct bnosample *smp) {
+   size_t head = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+   size_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+   if(head - tail > r->mask) return(-1);
+   r->slot[head & r->mask].smp = *smp;
+   __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * mpsc_push() - producers claim a slot by advancing head with  *
+ * CAS. A slot is free for position pos when its seq == pos, it *
+ * is published by setting seq = pos + 1.                       *
+ * ------------------------------------------------------------ */
+static int mpsc_push(struct bnoring *r, const struct bnosample *smp) {
+   size_t pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+   struct ringslot *s;
+
+   for(;;) {
+      s = &r->slot[pos & r->mask];
+      size_t seq = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+      intptr_t diff = (intptr_t) seq - (intptr_t) pos;
+      if(diff == 0) {
+         if(__atomic_compare_exchange_n(&r->head, &pos, pos + 1, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+      }
+      else if(diff < 0) return(-1);   // consumer has not freed it yet
+      else pos = __atomic_load_n(&r->head, __ATOMIC_RELAXED);
+   }
+   s->smp = *smp;
+   __atomic_store_n(&s->seq, pos + 1, __ATOMIC_RELEASE);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_push() - add one sample without blocking. Returns 0 *
+ * or -1 if the ring is full, the sample is then dropped.       *
+ * ------------------------------------------------------------ */
+int bno_ring_push(struct bnoring *r, const struct bnosample *smp) {
+   int res = r->mpsc ? mpsc_push(r, smp) : spsc_push(r, smp);
+   if(res != 0) {
+      __atomic_fetch_add(&r->overruns, 1, __ATOMIC_RELAXED);
+      return(-1);
+   }
+   ring_wake(r);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_push_wait() - add one sample, if the ring is full   *
+ * yield until the consumer made room or *stop is set. For data *
+ * sources that can wait, such as a capture replay. Returns 0,  *
+ * or -1 if stopped before the sample went in.                  *
+ * ------------------------------------------------------------ */
+int bno_ring_push_wait(struct bnoring *r, const struct bnosample *smp, const int *stop) {
+   while((r->mpsc ? mpsc_push(r, smp) : spsc_push(r, smp)) != 0) {
+      if(__atomic_load_n(stop, __ATOMIC_ACQUIRE)) return(-1);
+      sched_yield();
+   }
+   ring_wake(r);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_pop() - take the oldest sample, never blocks.       *
+ * Returns 0, or -1 if the ring is empty. Single consumer only. *
+ * ------------------------------------------------------------ */
+int bno_ring_pop(struct bnoring *r, struct bnosample *smp) {
+   size_t tail = __atomic_load_n(&r->tail, __ATOMIC_RELAXED);
+   struct ringslot *s = &r->slot[tail & r->mask];
+
+   if(r->mpsc) {
+      if(__atomic_load_n(&s->seq, __ATOMIC_ACQUIRE) != tail + 1) return(-1);
+      *smp = s->smp;
+      __atomic_store_n(&s->seq, tail + r->mask + 1, __ATOMIC_RELEASE);
+      __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELAXED);
+   }
+   else {
+      if(__atomic_load_n(&r->head, __ATOMIC_ACQUIRE) == tail) return(-1);
+      *smp = s->smp;
+      __atomic_store_n(&r->tail, tail + 1, __ATOMIC_RELEASE);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_read() - take the oldest sample, waiting up to      *
+ * timeout_ms for one (-1 = forever). Returns 0, or -1 if none  *
+ * arrived in time.                                             *
+ * ------------------------------------------------------------ */
+int bno_ring_read(struct bnoring *r, struct bnosample *smp, int timeout_ms) {
+   struct timespec now, until;
+   clock_gettime(CLOCK_MONOTONIC, &until);
+   until.tv_sec  += timeout_ms / 1000;
+   until.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+
+   for(;;) {
+      if(bno_ring_pop(r, smp) == 0) return(0);
+
+      /* --------------------------------------------------------- *
+       * announce the sleep, then look once more: a producer that *
+       * published before it saw waiting is caught by this retry  *
+       * --------------------------------------------------------- */
+      __atomic_store_n(&r->waiting, 1, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_SEQ_CST);
+      if(bno_ring_pop(r, smp) == 0) {
+         __atomic_store_n(&r->waiting, 0, __ATOMIC_RELAXED);
+         return(0);
+      }
+
+      int wait_ms = -1;
+      if(timeout_ms >= 0) {
+         clock_gettime(CLOCK_MONOTONIC, &now);
+         int64_t left = (int64_t)(until.tv_sec - now.tv_sec) * 1000
+                      + (until.tv_nsec - now.tv_nsec) / 1000000;
+         if(left <= 0) {
+            __atomic_store_n(&r->waiting, 0, __ATOMIC_RELAXED);
+            return(-1);
+         }
+         wait_ms = (int) left;
+      }
+
+      struct pollfd pfd = { r->efd, POLLIN, 0 };
+      while(poll(&pfd, 1, wait_ms) < 0 && errno == EINTR);
+      uint64_t count;
+      if(read(r->efd, &count, sizeof(count)) < 0 && errno != EAGAIN) {
+         __atomic_store_n(&r->waiting, 0, __ATOMIC_RELAXED);
+         return(-1);
+      }
+      __atomic_store_n(&r->waiting, 0, __ATOMIC_RELAXED);
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_overruns() - samples dropped because it was full    *
+ * ------------------------------------------------------------ */
+unsigned long bno_ring_overruns(struct bnoring *r) {
+   return __atomic_load_n(&r->overruns, __ATOMIC_RELAXED);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_ring_free() - release the ring, producers must be done   *
+ * ------------------------------------------------------------ */
+void bno_ring_free(struct bnoring *r) {
+   if(r == NULL) return;
+   close(r->efd);
+   free(r->slot);
+   free(r);
+}
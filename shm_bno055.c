@@ -0,0 +1,198 @@
+/* ------------------------------------------------------------ *
+ * file:        shm_bno055.c                                    *
+ * purpose:     Latest-sample publication in POSIX shared memory*
+ *              One process owns the bus and publishes each new *
+ *              snapshot into a per-sensor slot, guarded by a   *
+ *              seqlock. Any number of reader processes map the *
+ *              segment read-only and copy the newest sample out*
+ *              without syscalls, locks or bus access. Readers  *
+ *              only need this file, see libbno055shm.so.       *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "getbno055.h"
+
+#define SHM_MAGIC   0x424E4F35   // "BNO5"
+#define SHM_VERSION 1
+#define SHM_READ_TRIES 100000    // slot copies before giving up, ~ms
+
+
+/* ------------------------------------------------------------ *
+ * Segment layout. seq is odd while the publisher writes the    *
+ * slot, it advances by 2 per sample. Slots are cache aligned,  *
+ * so a write to one sensor does not disturb readers of another.*
+ * ------------------------------------------------------------ */
+struct shmslot{
+   uint32_t seq __attribute__((aligned(64)));
+   struct bnosample smp;
+};
+
+struct shmlayout{
+   uint32_t magic;                     // SHM_MAGIC, set last
+   uint32_t version;                   // SHM_VERSION
+   uint32_t slotsize;                  // sizeof(struct shmslot)
+   uint32_t nslots;                    // BNO_ACQ_MAX
+   struct shmslot slot[BNO_ACQ_MAX];
+};
+
+struct bnoshm{
+   struct shmlayout *map;              // the mapped segment
+   char name[256];                     // shm name, e.g. /bno055
+   int  owner;                         // 1 = publisher, unlinks it
+};
+
+/* ------------------------------------------------------------ *
+ * bno_shm_create() - create (or take over) the segment name    *
+ * and map it for publishing. Returns NULL on errors.           *
+ * ------------------------------------------------------------ */
+struct bnoshm *bno_shm_create(const char *name, int verbose) {
+   if(strlen(name) >= sizeof(((struct bnoshm*)0)->name)) {
+      BNO_ERROR("Error: invalid shared memory name [%s].\n", name);
+      return(NULL);
+   }
+   int fd = shm_open(name, O_RDWR | O_CREAT, 0644);
+   if(fd < 0) {
+      BNO_ERROR("Error: cannot create shared memory [%s].\n", name);
+      return(NULL);
+   }
+   if(ftruncate(fd, sizeof(struct shmlayout)) != 0) {
+      BNO_ERROR("Error: cannot size shared memory [%s].\n", name);
+      close(fd);
+      return(NULL);
+   }
+   void *map = mmap(NULL, sizeof(struct shmlayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   close(fd);
+   if(map == MAP_FAILED) {
+      BNO_ERROR("Error: cannot map shared memory [%s].\n", name);
+      return(NULL);
+   }
+
+   struct bnoshm *shm = calloc(1, sizeof(struct bnoshm));
+   if(shm == NULL) {
+      munmap(map, sizeof(struct shmlayout));
+      return(NULL);
+   }
+   shm->map = map;
+   shm->owner = 1;
+   strcpy(shm->name, name);
+
+   memset(shm->map, 0, sizeof(struct shmlayout));
+   shm->map->version  = SHM_VERSION;
+   shm->map->slotsize = sizeof(struct shmslot);
+   shm->map->nslots   = BNO_ACQ_MAX;
+   __atomic_store_n(&shm->map->magic, SHM_MAGIC, __ATOMIC_RELEASE);
+
+   BNO_DEBUG(verbose, "Debug: publishing to shared memory [%s], %zu bytes\n", name, sizeof(struct shmlayout));
+   return(shm);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shm_publish() - store smp as the newest sample of sensor *
+ * smp->sensor. Single publisher only. Returns -1 for a bad     *
+ * sensor index.                                                *
+ * ------------------------------------------------------------ */
+int bno_shm_publish(struct bnoshm *shm, const struct bnosample *smp) {
+   if(smp->sensor < 0 || smp->sensor >= BNO_ACQ_MAX) return(-1);
+   struct shmslot *s = &shm->map->slot[smp->sensor];
+
+   uint32_t seq = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+   __atomic_store_n(&s->seq, seq + 1, __ATOMIC_RELAXED);
+   __atomic_thread_fence(__ATOMIC_RELEASE);
+   memcpy(&s->smp, smp, sizeof(struct bnosample));
+   __atomic_store_n(&s->seq, seq + 2, __ATOMIC_RELEASE);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shm_open() - map an existing segment read-only. Returns  *
+ * NULL if it does not exist or has a different layout.         *
+ * ------------------------------------------------------------ */
+struct bnoshm *bno_shm_open(const char *name) {
+   if(strlen(name) >= sizeof(((struct bnoshm*)0)->name)) {
+      BNO_ERROR("Error: invalid shared memory name [%s].\n", name);
+      return(NULL);
+   }
+   int fd = shm_open(name, O_RDONLY, 0);
+   if(fd < 0) {
+      BNO_ERROR("Error: cannot open shared memory [%s], no publisher running?\n", name);
+      return(NULL);
+   }
+   struct stat st;
+   if(fstat(fd, &st) != 0 || st.st_size < (off_t) sizeof(struct shmlayout)) {
+      BNO_ERROR("Error: shared memory [%s] has the wrong size.\n", name);
+      close(fd);
+      return(NULL);
+   }
+   struct shmlayout *map = mmap(NULL, sizeof(struct shmlayout), PROT_READ, MAP_SHARED, fd, 0);
+   close(fd);
+   if(map == MAP_FAILED) {
+      BNO_ERROR("Error: cannot map shared memory [%s].\n", name);
+      return(NULL);
+   }
+   if(__atomic_load_n(&map->magic, __ATOMIC_ACQUIRE) != SHM_MAGIC
+      || map->version != SHM_VERSION || map->slotsize != sizeof(struct shmslot)
+      || map->nslots != BNO_ACQ_MAX) {
+      BNO_ERROR("Error: shared memory [%s] has an unknown layout.\n", name);
+      munmap(map, sizeof(struct shmlayout));
+      return(NULL);
+   }
+
+   struct bnoshm *shm = calloc(1, sizeof(struct bnoshm));
+   if(shm == NULL) {
+      munmap(map, sizeof(struct shmlayout));
+      return(NULL);
+   }
+   shm->map = map;
+   strcpy(shm->name, name);
+   return(shm);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shm_read() - copy the newest sample of a sensor. Retries *
+ * while the publisher is writing the slot. Returns the number  *
+ * of samples published so far (changes with each new one), 0  *
+ * if none yet, or -1 for a bad sensor index. Also -1 with errno*
+ * EAGAIN if the slot stayed mid-write for SHM_READ_TRIES, e.g. *
+ * because the publisher died while writing it.                 *
+ * ------------------------------------------------------------ */
+long bno_shm_read(struct bnoshm *shm, int sensor, struct bnosample *smp) {
+   if(sensor < 0 || sensor >= BNO_ACQ_MAX) return(-1);
+   const struct shmslot *s = &shm->map->slot[sensor];
+   uint32_t seq1, seq2 = 0;
+   int tries = 0;
+
+   do {
+      if(++tries > SHM_READ_TRIES) {
+         errno = EAGAIN;
+         return(-1);
+      }
+      if((tries & 63) == 0) sched_yield();   // let a descheduled writer finish
+      seq1 = __atomic_load_n(&s->seq, __ATOMIC_ACQUIRE);
+      if(seq1 & 1) continue;           // write in progress
+      memcpy(smp, &s->smp, sizeof(struct bnosample));
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      seq2 = __atomic_load_n(&s->seq, __ATOMIC_RELAXED);
+   } while((seq1 & 1) || seq1 != seq2);
+
+   return(seq1 / 2);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_shm_close() - unmap, the publisher also removes the name *
+ * ------------------------------------------------------------ */
+void bno_shm_close(struct bnoshm *shm) {
+   if(shm == NULL) return;
+   munmap(shm->map, sizeof(struct shmlayout));
+   if(shm->owner) shm_unlink(shm->name);
+   free(shm);
+}
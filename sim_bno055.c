@@ -0,0 +1,463 @@
+/* ------------------------------------------------------------ *
+ * file:        sim_bno055.c                                    *
+ * purpose:     Simulated BNO055 bus transport. Models the page *
+ *              0 and page 1 register maps, register address    *
+ *              auto-increment, the OPR_MODE switch times, the  *
+ *              reset boot time and a slowly moving sensor, so  *
+ *              the library can be run and benchmarked without  *
+ *              hardware. Selected with the bus name "sim", or  *
+ *              "sim:<hz>" to also charge the I2C bus time for  *
+ *              each transaction at the given SCL clock rate.   *
+ *              "sim:<hz>:<ppm>" also NACKs that many of a      *
+ *              million transactions at random, like a noisy    *
+ *              bus, to exercise the retry code.                *
+ *              The simulator starts up in NDOF fusion mode.    *
+ *              The INT pin is a timerfd, see sim_irq_line().   *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * Datasheet timings: config->any 7ms, any->config 19ms, after  *
+ * a reset the sensor does not respond for 650ms.               *
+ * ------------------------------------------------------------ */
+#define SIM_CONFIG_TO_ANY_NS    7000000LL
+#define SIM_ANY_TO_CONFIG_NS   19000000LL
+#define SIM_BOOT_NS           650000000LL
+#define SIM_ODR_HZ            100
+
+/* ------------------------------------------------------------ *
+ * Sensors that update their data registers in each ops mode,   *
+ * indexed by opmode_t. Bit-0 acc, bit-1 mag, bit-2 gyr, bit-3  *
+ * fusion output (Euler, quaternion, gravity, linear accel).    *
+ * ------------------------------------------------------------ */
+#define SIM_ACC 0x01
+#define SIM_MAG 0x02
+#define SIM_GYR 0x04
+#define SIM_FUS 0x08
+static const unsigned char sim_mode_sensors[13] = {
+   0,                                    // config
+   SIM_ACC, SIM_MAG, SIM_GYR,            // acconly, magonly, gyronly
+   SIM_ACC|SIM_MAG, SIM_ACC|SIM_GYR,     // accmag, accgyro
+   SIM_MAG|SIM_GYR,                      // maggyro
+   SIM_ACC|SIM_MAG|SIM_GYR,              // amg
+   SIM_ACC|SIM_GYR|SIM_FUS,              // imu
+   SIM_ACC|SIM_MAG|SIM_FUS,              // compass
+   SIM_ACC|SIM_MAG|SIM_FUS,              // m4g
+   SIM_ACC|SIM_MAG|SIM_GYR|SIM_FUS,      // ndof
+   SIM_ACC|SIM_MAG|SIM_GYR|SIM_FUS       // ndof_fmc
+};
+
+struct simdev{
+   unsigned char page[2][REGISTERMAP_END + 1]; // register maps
+   int64_t t0;           // open time, motion time base
+   int64_t boot_until;   // no response before this time
+   int64_t switch_at;    // pending OPR_MODE takes effect
+   int pending_mode;     // -1 if no mode switch is pending
+   int64_t fusion_since; // fusion start, drives calib status
+   int64_t last_sample;  // sample index of the data registers
+   long bus_hz;          // emulated SCL clock, 0 = no delay
+   long nack_ppm;        // injected NACKs per million transactions
+   unsigned int seed;    // rand_r() state of the NACK injection
+   int irqfd;            // INT pin stand-in (timerfd), -1 = none
+   int int_line;         // INT pin asserted, until RST_INT
+   int64_t int_at;       // INT pin goes high at this time, 0 = never
+};
+
+static int64_t sim_now() {
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+/* ------------------------------------------------------------ *
+ * sim_defaults() - register reset values from the datasheet    *
+ * ------------------------------------------------------------ */
+static void sim_defaults(struct simdev *sim) {
+   memset(sim->page, 0, sizeof(sim->page));
+   unsigned char *p0 = sim->page[0];
+   unsigned char *p1 = sim->page[1];
+
+   p0[BNO055_CHIP_ID_ADDR] = BNO055_ID;
+   p0[0x01] = 0xFB;                      // accelerometer ID
+   p0[0x02] = 0x32;                      // magnetometer ID
+   p0[0x03] = 0x0F;                      // gyroscope ID
+   p0[0x04] = 0x11;                      // SW revision LSB
+   p0[0x05] = 0x03;                      // SW revision MSB
+   p0[0x06] = 0x15;                      // bootloader revision
+   p0[BNO055_TEMP_ADDR] = 25;
+   p0[BNO055_SELFTSTRES_ADDR] = 0x0F;    // all self tests passed
+   p0[BNO055_UNIT_SEL_ADDR] = 0x80;      // Android orientation
+   p0[BNO055_OPR_MODE_ADDR] = config;
+   p0[BNO055_PWR_MODE_ADDR] = normal;
+   p0[BNO055_AXIS_MAP_CONFIG_ADDR] = 0x24;
+   p0[BNO055_AXIS_MAP_SIGN_ADDR] = 0x00;
+   p0[ACCEL_RADIUS_LSB_ADDR] = 0xE8;     // 1000
+   p0[ACCEL_RADIUS_MSB_ADDR] = 0x03;
+   p0[MAG_RADIUS_LSB_ADDR] = 0xE0;       // 480
+   p0[MAG_RADIUS_MSB_ADDR] = 0x01;
+
+   p1[BNO055_PAGE_ID_ADDR] = 0x01;
+   p1[BNO055_ACC_CONFIG_ADDR] = 0x0D;
+   p1[BNO055_MAG_CONFIG_ADDR] = 0x0B;
+   p1[BNO055_GYR_CONFIG0_ADDR] = 0x38;
+   p1[BNO055_GYR_CONFIG1_ADDR] = 0x00;
+
+   sim->pending_mode = -1;
+   sim->fusion_since = 0;
+   sim->last_sample = -1;
+}
+
+static void sim_put16(unsigned char *reg, double val) {
+   if(val > 32767.0) val = 32767.0;
+   if(val < -32768.0) val = -32768.0;
+   int16_t v = (int16_t) lrint(val);
+   reg[0] = v & 0xFF;
+   reg[1] = (v >> 8) & 0xFF;
+}
+
+/* ------------------------------------------------------------ *
+ * sim_motion() - fill the data registers with synthetic motion *
+ * at time t (seconds): heading turns 18 deg/s, roll and pitch  *
+ * swing slowly, plus a small linear acceleration. Values are   *
+ * written in the units selected by UNIT_SEL.                   *
+ * ------------------------------------------------------------ */
+static void sim_motion(struct simdev *sim, double t, int sensors) {
+   unsigned char *p0 = sim->page[0];
+   unsigned char usel = p0[BNO055_UNIT_SEL_ADDR];
+   const double d2r = M_PI / 180.0;
+
+   double head = fmod(18.0 * t, 360.0);
+   double roll = 10.0 * sin(2.0 * M_PI * t / 8.0);
+   double pitc = 5.0 * sin(2.0 * M_PI * t / 5.0);
+   double droll = 10.0 * (2.0 * M_PI / 8.0) * cos(2.0 * M_PI * t / 8.0);
+   double dpitc = 5.0 * (2.0 * M_PI / 5.0) * cos(2.0 * M_PI * t / 5.0);
+
+   /* --------------------------------------------------------- *
+    * Orientation quaternion, ZYX order: heading, pitch, roll   *
+    * --------------------------------------------------------- */
+   double cy = cos(head * d2r / 2), sy = sin(head * d2r / 2);
+   double cp = cos(pitc * d2r / 2), sp = sin(pitc * d2r / 2);
+   double cr = cos(roll * d2r / 2), sr = sin(roll * d2r / 2);
+   double qw = cr * cp * cy + sr * sp * sy;
+   double qx = sr * cp * cy - cr * sp * sy;
+   double qy = cr * sp * cy + sr * cp * sy;
+   double qz = cr * cp * sy - sr * sp * cy;
+
+   /* --------------------------------------------------------- *
+    * Gravity and earth magnetic field in the sensor frame      *
+    * --------------------------------------------------------- */
+   double g = 9.80665;
+   double grav[3] = { -g * sin(pitc * d2r),
+                       g * sin(roll * d2r) * cos(pitc * d2r),
+                       g * cos(roll * d2r) * cos(pitc * d2r) };
+   double lin[3] = { 0.2 * sin(2.0 * M_PI * t / 3.0),
+                     0.1 * cos(2.0 * M_PI * t / 3.0),
+                     0.0 };
+   double bn = 20.0, bd = -40.0;         // microTesla, north and down
+   double mag[3] = { bn * cos(head * d2r), -bn * sin(head * d2r), bd };
+
+   double afact = ((usel >> 0) & 0x01) ? 1000.0 / g : 100.0; // mg or m/s2
+   double gfact = ((usel >> 1) & 0x01) ? 900.0 * d2r : 16.0;  // rps or dps
+   double efact = ((usel >> 2) & 0x01) ? 900.0 * d2r : 16.0;  // rad or deg
+
+   if(sensors & SIM_ACC) {
+      sim_put16(&p0[BNO055_ACC_DATA_X_LSB_ADDR], (grav[0] + lin[0]) * afact);
+      sim_put16(&p0[BNO055_ACC_DATA_Y_LSB_ADDR], (grav[1] + lin[1]) * afact);
+      sim_put16(&p0[BNO055_ACC_DATA_Z_LSB_ADDR], (grav[2] + lin[2]) * afact);
+   }
+   if(sensors & SIM_MAG) {
+      sim_put16(&p0[BNO055_MAG_DATA_X_LSB_ADDR], mag[0] * 16.0);
+      sim_put16(&p0[BNO055_MAG_DATA_Y_LSB_ADDR], mag[1] * 16.0);
+      sim_put16(&p0[BNO055_MAG_DATA_Z_LSB_ADDR], mag[2] * 16.0);
+   }
+   if(sensors & SIM_GYR) {
+      sim_put16(&p0[BNO055_GYRO_DATA_X_LSB_ADDR], droll * gfact);
+      sim_put16(&p0[BNO055_GYRO_DATA_Y_LSB_ADDR], dpitc * gfact);
+      sim_put16(&p0[BNO055_GYRO_DATA_Z_LSB_ADDR], 18.0 * gfact);
+   }
+   if(sensors & SIM_FUS) {
+      sim_put16(&p0[BNO055_EULER_H_LSB_ADDR], head * efact);
+      sim_put16(&p0[BNO055_EULER_R_LSB_ADDR], roll * efact);
+      sim_put16(&p0[BNO055_EULER_P_LSB_ADDR], pitc * efact);
+      sim_put16(&p0[BNO055_QUATERNION_DATA_W_LSB_ADDR], qw * 16384.0);
+      sim_put16(&p0[BNO055_QUATERNION_DATA_X_LSB_ADDR], qx * 16384.0);
+      sim_put16(&p0[BNO055_QUATERNION_DATA_Y_LSB_ADDR], qy * 16384.0);
+      sim_put16(&p0[BNO055_QUATERNION_DATA_Z_LSB_ADDR], qz * 16384.0);
+      sim_put16(&p0[BNO055_LIN_ACC_DATA_X_LSB_ADDR], lin[0] * afact);
+      sim_put16(&p0[BNO055_LIN_ACC_DATA_Y_LSB_ADDR], lin[1] * afact);
+      sim_put16(&p0[BNO055_LIN_ACC_DATA_Z_LSB_ADDR], lin[2] * afact);
+      sim_put16(&p0[BNO055_GRAVITY_DATA_X_LSB_ADDR], grav[0] * afact);
+      sim_put16(&p0[BNO055_GRAVITY_DATA_Y_LSB_ADDR], grav[1] * afact);
+      sim_put16(&p0[BNO055_GRAVITY_DATA_Z_LSB_ADDR], grav[2] * afact);
+   }
+   p0[BNO055_TEMP_ADDR] = 25 + (int)(2.0 * sin(t / 60.0));
+}
+
+/* ------------------------------------------------------------ *
+ * sim_int_bits() - interrupts the simulated motion can raise:  *
+ * the sensor never rests, so any-motion of the active sensors. *
+ * ------------------------------------------------------------ */
+static int sim_int_bits(int sensors) {
+   return ((sensors & SIM_ACC) ? BNO055_INT_ACC_AM : 0)
+        | ((sensors & SIM_GYR) ? BNO055_INT_GYR_AM : 0);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_int_arm() - schedule the INT pin for the next data sample*
+ * if a motion interrupt is enabled and routed to the pin, and  *
+ * the pin is not latched high already. The timerfd expires at  *
+ * the same time, which makes it poll()-able like a GPIO edge.  *
+ * ------------------------------------------------------------ */
+static void sim_int_arm(struct simdev *sim, int64_t now) {
+   unsigned char *p1 = sim->page[1];
+   int mode = sim->page[0][BNO055_OPR_MODE_ADDR] & 0x0F;
+   int sensors = (mode <= ndof_fmc) ? sim_mode_sensors[mode] : 0;
+   int64_t period = 1000000000LL / SIM_ODR_HZ;
+
+   sim->int_at = 0;
+   if(!sim->int_line && (p1[BNO055_INT_EN_ADDR] & p1[BNO055_INT_MSK_ADDR] & sim_int_bits(sensors)))
+      sim->int_at = sim->t0 + ((now - sim->t0) / period + 1) * period;
+
+   if(sim->irqfd < 0) return;
+   struct itimerspec its;
+   memset(&its, 0, sizeof(its));
+   its.it_value.tv_sec  = sim->int_at / 1000000000LL;
+   its.it_value.tv_nsec = sim->int_at % 1000000000LL;
+   timerfd_settime(sim->irqfd, TFD_TIMER_ABSTIME, &its, NULL);  // 0 disarms
+}
+
+/* ------------------------------------------------------------ *
+ * sim_update() - advance the simulated sensor to time now:     *
+ * complete a pending mode switch, refresh the data registers   *
+ * at the 100Hz output rate and advance the calibration state.  *
+ * ------------------------------------------------------------ */
+static void sim_update(struct simdev *sim, int64_t now) {
+   unsigned char *p0 = sim->page[0];
+
+   if(sim->pending_mode >= 0 && now >= sim->switch_at) {
+      p0[BNO055_OPR_MODE_ADDR] = sim->pending_mode;
+      sim->pending_mode = -1;
+      if(p0[BNO055_OPR_MODE_ADDR] >= imu) sim->fusion_since = now;
+      else sim->fusion_since = 0;
+      sim_int_arm(sim, sim->switch_at);
+   }
+
+   int mode = p0[BNO055_OPR_MODE_ADDR] & 0x0F;
+   int sensors = (mode <= ndof_fmc) ? sim_mode_sensors[mode] : 0;
+
+   if(sim->int_at > 0 && now >= sim->int_at) {
+      p0[BNO055_INTR_STAT_ADDR] |= sim->page[1][BNO055_INT_EN_ADDR] & sim_int_bits(sensors);
+      sim->int_line = 1;
+      sim->int_at = 0;
+   }
+
+   if(mode == config) p0[BNO055_SYS_STAT_ADDR] = 0x00;      // idle
+   else if(sensors & SIM_FUS) p0[BNO055_SYS_STAT_ADDR] = 0x05;
+   else p0[BNO055_SYS_STAT_ADDR] = 0x06;
+
+   /* --------------------------------------------------------- *
+    * Calibration improves one step per second in fusion mode,  *
+    * gyroscope first, then accelerometer, magnetometer, system *
+    * --------------------------------------------------------- */
+   if(sim->fusion_since > 0) {
+      int64_t secs = (now - sim->fusion_since) / 1000000000LL;
+      int g = secs > 3 ? 3 : (int) secs;
+      int a = secs > 4 ? 3 : (secs > 1 ? (int) secs - 1 : 0);
+      int m = secs > 5 ? 3 : (secs > 2 ? (int) secs - 2 : 0);
+      int s = (g < a ? (g < m ? g : m) : (a < m ? a : m));
+      p0[BNO055_CALIB_STAT_ADDR] = (s << 6) | (g << 4) | (a << 2) | m;
+   }
+
+   int64_t sample = (now - sim->t0) / (1000000000LL / SIM_ODR_HZ);
+   if(sensors != 0 && sample != sim->last_sample) {
+      sim_motion(sim, (double) sample / SIM_ODR_HZ, sensors);
+      sim->last_sample = sample;
+   }
+}
+
+/* ------------------------------------------------------------ *
+ * sim_bus_time() - charge the I2C wire time of a transaction,  *
+ * 9 clocks per byte plus start/stop, if a bus rate was given.  *
+ * ------------------------------------------------------------ */
+static void sim_bus_time(struct simdev *sim, int bytes) {
+   if(sim->bus_hz <= 0) return;
+   int64_t ns = ((int64_t) bytes * 9 + 2) * 1000000000LL / sim->bus_hz;
+   struct timespec ts = { ns / 1000000000LL, ns % 1000000000LL };
+   nanosleep(&ts, NULL);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_nack() - no ACK while booting, or an injected bus fault  *
+ * ------------------------------------------------------------ */
+static int sim_nack(struct simdev *sim, int64_t now) {
+   if(now < sim->boot_until ||
+      (sim->nack_ppm > 0 && rand_r(&sim->seed) % 1000000 < sim->nack_ppm)) {
+      errno = EREMOTEIO;
+      return(1);
+   }
+   return(0);
+}
+
+static int sim_open(struct bnotransport *t, const char *bus, int addr) {
+   struct simdev *sim = calloc(1, sizeof(struct simdev));
+   if(sim == NULL) return(-1);
+
+   if(bus[3] == ':') {
+      char *end;
+      sim->bus_hz = strtol(&bus[4], &end, 10);
+      if(*end == ':') sim->nack_ppm = strtol(end + 1, NULL, 10);
+   }
+   sim->seed = 1;
+   sim_defaults(sim);
+   sim->t0 = sim_now();
+   sim->irqfd = -1;
+   t->priv = sim;
+
+   /* --------------------------------------------------------- *
+    * Each program run opens a fresh simulator. Start it up in  *
+    * NDOF, as if the sensor was configured earlier, so data    *
+    * reads work right away. After a reset it is in CONFIG.     *
+    * --------------------------------------------------------- */
+   sim->page[0][BNO055_OPR_MODE_ADDR] = ndof;
+   sim->fusion_since = sim->t0;
+   BNO_DEBUG(t->verbose, "Debug: Simulated BNO055 at [0x%02X], bus clock [%ld Hz], NACK rate [%ld ppm]\n",
+             addr, sim->bus_hz, sim->nack_ppm);
+   return(0);
+}
+
+static int sim_read_regs(struct bnotransport *t, unsigned char reg, void *buf, int len) {
+   struct simdev *sim = t->priv;
+   int64_t now = sim_now();
+
+   sim_bus_time(sim, 3 + len);
+   if(sim_nack(sim, now)) return(-1);
+   sim_update(sim, now);
+
+   unsigned char *map = sim->page[sim->page[0][BNO055_PAGE_ID_ADDR] & 0x01];
+   unsigned char *out = buf;
+   int i;
+   for(i = 0; i < len; i++) {
+      int r = reg + i;         // register address auto-increment
+      out[i] = (r <= REGISTERMAP_END) ? map[r] : 0xFF;
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_write_reg() - register write side effects. Most config   *
+ * registers only accept writes in CONFIG mode, like the chip.  *
+ * ------------------------------------------------------------ */
+static void sim_write_reg(struct simdev *sim, int pg, int reg, unsigned char val, int64_t now) {
+   unsigned char *p0 = sim->page[0];
+   int mode = p0[BNO055_OPR_MODE_ADDR] & 0x0F;
+
+   if(reg == BNO055_PAGE_ID_ADDR) {
+      p0[BNO055_PAGE_ID_ADDR] = val & 0x01;
+      sim->page[1][BNO055_PAGE_ID_ADDR] = val & 0x01;
+      return;
+   }
+   if(pg == 1) {
+      if(mode == config && reg >= BNO055_ACC_CONFIG_ADDR && reg <= 0x1F)
+         sim->page[1][reg] = val;
+      if(reg == BNO055_INT_MSK_ADDR || reg == BNO055_INT_EN_ADDR) sim_int_arm(sim, now);
+      return;
+   }
+
+   switch(reg) {
+      case BNO055_OPR_MODE_ADDR:
+         sim->pending_mode = val & 0x0F;
+         sim->switch_at = now + ((val & 0x0F) == config ? SIM_ANY_TO_CONFIG_NS : SIM_CONFIG_TO_ANY_NS);
+         break;
+      case BNO055_SYS_TRIGGER_ADDR:
+         if(val & 0x20) {      // RST_SYS
+            sim_defaults(sim);
+            sim->int_line = 0;
+            sim_int_arm(sim, now);
+            sim->boot_until = now + SIM_BOOT_NS;
+            return;
+         }
+         if(val & 0x40) {      // RST_INT
+            p0[BNO055_INTR_STAT_ADDR] = 0;
+            sim->int_line = 0;
+            sim_int_arm(sim, now);
+         }
+         p0[BNO055_SYS_TRIGGER_ADDR] = val & 0x81;
+         break;
+      case BNO055_UNIT_SEL_ADDR:
+      case BNO055_PWR_MODE_ADDR:
+      case BNO055_TEMP_SOURCE_ADDR:
+      case BNO055_AXIS_MAP_CONFIG_ADDR:
+      case BNO055_AXIS_MAP_SIGN_ADDR:
+         if(mode == config) p0[reg] = val;
+         break;
+      default:
+         if(reg >= BNO055_SIC_MATRIX_0_LSB_ADDR && reg <= MAG_RADIUS_MSB_ADDR && mode == config)
+            p0[reg] = val;
+         break;
+   }
+}
+
+static int sim_write_regs(struct bnotransport *t, unsigned char reg, const void *buf, int len) {
+   struct simdev *sim = t->priv;
+   int64_t now = sim_now();
+
+   sim_bus_time(sim, 2 + len);
+   if(sim_nack(sim, now)) return(-1);
+   sim_update(sim, now);
+
+   const unsigned char *in = buf;
+   int pg = sim->page[0][BNO055_PAGE_ID_ADDR] & 0x01;
+   int i;
+   for(i = 0; i < len && reg + i <= REGISTERMAP_END; i++) {
+      sim_write_reg(sim, pg, reg + i, in[i], now);
+      if(sim->boot_until > now) break;   // reset ends the write
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * sim_irq_line() - the INT pin stand-in: a timerfd that becomes*
+ * readable when the simulated pin goes high. The reader has to *
+ * read() the 8 byte expiry count, like a GPIO edge event.      *
+ * ------------------------------------------------------------ */
+static int sim_irq_line(struct bnotransport *t) {
+   struct simdev *sim = t->priv;
+   if(sim->irqfd < 0) {
+      sim->irqfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+      if(sim->irqfd < 0) return(-1);
+   }
+   int64_t now = sim_now();
+   sim_update(sim, now);
+   if(sim->int_at == 0) sim_int_arm(sim, now);
+   return(sim->irqfd);
+}
+
+static void sim_close(struct bnotransport *t) {
+   struct simdev *sim = t->priv;
+   if(sim->irqfd >= 0) close(sim->irqfd);
+   free(t->priv);
+   t->priv = NULL;
+}
+
+const struct bnotransport bno_sim_transport = {
+   "sim",
+   sim_open,
+   sim_read_regs,
+   NULL,
+   sim_write_regs,
+   sim_close,
+   sim_irq_line,
+   NULL,
+   NULL
+};
@@ -0,0 +1,197 @@
+/* ------------------------------------------------------------ *
+ * file:        sub_bno055.c                                    *
+ * purpose:     Subscription protocol of the bno055d daemon.    *
+ *              Frame encoding for the daemon, and the client   *
+ *              side: connect to the daemon socket, subscribe   *
+ *              to fields and a rate, receive decoded samples.  *
+ *              The socket is SOCK_SEQPACKET, one frame is one  *
+ *              message, values are in host byte order.         *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "getbno055.h"
+
+/* ------------------------------------------------------------ *
+ * putv()/getv() - vectors travel as float, half the size of    *
+ * double and well above the sensor resolution                  *
+ * ------------------------------------------------------------ */
+static unsigned char *putv(unsigned char *p, const double *v, int n) {
+   float f[4];
+   int i;
+   for(i = 0; i < n; i++) f[i] = v[i];
+   memcpy(p, f, n * sizeof(float));
+   return(p + n * sizeof(float));
+}
+
+static const unsigned char *getv(const unsigned char *p, double *v, int n) {
+   float f[4];
+   int i;
+   memcpy(f, p, n * sizeof(float));
+   for(i = 0; i < n; i++) v[i] = f[i];
+   return(p + n * sizeof(float));
+}
+
+/* ------------------------------------------------------------ *
+ * bno_frame_size() - frame length for a field mask             *
+ * ------------------------------------------------------------ */
+int bno_frame_size(uint16_t fields) {
+   int len = sizeof(struct bnoframe);
+#define VEC_SIZE(f, F, reg, n, ...) \
+   if(fields & BNO_F_##F) len += n * sizeof(float);
+   BNO_VECTORS(VEC_SIZE)
+#undef VEC_SIZE
+   if(fields & BNO_F_STAT) len += 8;
+   return(len);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_frame_encode() - build the frame for the selected fields *
+ * of a sample in buf, BNO_FRAME_MAX bytes. Returns its length. *
+ * The caller fills in the per-client seq and dropped counters. *
+ * ------------------------------------------------------------ */
+int bno_frame_encode(const struct bnosample *smp, uint16_t fields, unsigned char *buf) {
+   const struct bnosnap *d = &smp->snap;
+   struct bnoframe hdr;
+
+   fields &= BNO_F_ALL;
+   memset(&hdr, 0, sizeof(hdr));
+   hdr.len       = bno_frame_size(fields);
+   hdr.fields    = fields;
+   hdr.sensor    = smp->sensor;
+   hdr.xfer_us   = d->ts.xfer_ns / 1000 > 0xFFFF ? 0xFFFF : d->ts.xfer_ns / 1000;
+   hdr.tstamp_ns = (int64_t) d->ts.tstamp.tv_sec * 1000000000LL + d->ts.tstamp.tv_nsec;
+   memcpy(buf, &hdr, sizeof(hdr));
+
+   unsigned char *p = buf + sizeof(hdr);
+   double v[4];
+#define VEC_PUT(f, F, reg, n, div0, div1, name, axis, ...) \
+   if(fields & BNO_F_##F) { \
+      BNO_VEC_LOAD##n(&d->f, v, __VA_ARGS__); \
+      p = putv(p, v, n); \
+   }
+   BNO_VECTORS(VEC_PUT)
+#undef VEC_PUT
+   if(fields & BNO_F_STAT) {
+      p[0] = d->temp_val;
+      p[1] = d->scal_st;
+      p[2] = d->gcal_st;
+      p[3] = d->acal_st;
+      p[4] = d->mcal_st;
+      p[5] = d->sys_stat;
+      p[6] = d->sys_err;
+      p[7] = d->unitsel;
+      p += 8;
+   }
+   return(p - buf);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_frame_decode() - unpack a received frame into hdr and    *
+ * smp, fields not in the frame are zeroed. Returns -1 if the   *
+ * frame is truncated or its length does not match the fields.  *
+ * ------------------------------------------------------------ */
+int bno_frame_decode(const unsigned char *buf, int len, struct bnoframe *hdr, struct bnosample *smp) {
+   if(len < (int) sizeof(struct bnoframe)) return(-1);
+   memcpy(hdr, buf, sizeof(struct bnoframe));
+   if(hdr->len != len || bno_frame_size(hdr->fields) != len) return(-1);
+
+   struct bnosnap *d = &smp->snap;
+   memset(smp, 0, sizeof(struct bnosample));
+   smp->sensor = hdr->sensor;
+   d->ts.tstamp.tv_sec  = hdr->tstamp_ns / 1000000000LL;
+   d->ts.tstamp.tv_nsec = hdr->tstamp_ns % 1000000000LL;
+   d->ts.xfer_ns = (long) hdr->xfer_us * 1000;
+
+   const unsigned char *p = buf + sizeof(struct bnoframe);
+   double v[4];
+#define VEC_GET(f, F, reg, n, div0, div1, name, axis, ...) \
+   if(hdr->fields & BNO_F_##F) { \
+      p = getv(p, v, n); \
+      BNO_VEC_STORE##n(&d->f, v, __VA_ARGS__); \
+   }
+   BNO_VECTORS(VEC_GET)
+#undef VEC_GET
+   if(hdr->fields & BNO_F_STAT) {
+      d->temp_val = p[0];
+      d->scal_st  = p[1];
+      d->gcal_st  = p[2];
+      d->acal_st  = p[3];
+      d->mcal_st  = p[4];
+      d->sys_stat = p[5];
+      d->sys_err  = p[6];
+      d->unitsel  = p[7];
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_sub_connect() - connect to the daemon socket at path,    *
+ * NULL for BNO_SOCK_PATH. Returns the socket fd, or -1.        *
+ * ------------------------------------------------------------ */
+int bno_sub_connect(const char *path) {
+   struct sockaddr_un sa;
+   if(path == NULL) path = BNO_SOCK_PATH;
+   if(strlen(path) >= sizeof(sa.sun_path)) {
+      BNO_ERROR("Error: socket path too long [%s].\n", path);
+      return(-1);
+   }
+   memset(&sa, 0, sizeof(sa));
+   sa.sun_family = AF_UNIX;
+   strcpy(sa.sun_path, path);
+
+   int fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+   if(fd < 0) {
+      BNO_ERROR("Error: cannot create a socket.\n");
+      return(-1);
+   }
+   if(connect(fd, (struct sockaddr *) &sa, sizeof(sa)) != 0) {
+      BNO_ERROR("Error: cannot connect to bno055d at [%s].\n", path);
+      close(fd);
+      return(-1);
+   }
+   return(fd);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_sub_request() - (re)subscribe: fields is a BNO_F_ mask,  *
+ * sensors a bitmask of sensor indexes (0 = all), hz the frame  *
+ * rate per sensor (0 = every sample). fields 0 pauses.         *
+ * ------------------------------------------------------------ */
+int bno_sub_request(int fd, uint16_t fields, uint32_t sensors, uint16_t hz) {
+   struct bnosubreq req;
+   memset(&req, 0, sizeof(req));
+   req.fields  = fields;
+   req.rate    = hz;
+   req.sensors = sensors;
+   if(send(fd, &req, sizeof(req), MSG_NOSIGNAL) != sizeof(req)) {
+      BNO_ERROR("Error: cannot send the subscription to bno055d.\n");
+      return(-1);
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_sub_read() - wait for the next frame and decode it. hdr  *
+ * carries the frame counter and the frames dropped so far for  *
+ * this client. Returns 0, or -1 on errors and daemon shutdown. *
+ * ------------------------------------------------------------ */
+int bno_sub_read(int fd, struct bnoframe *hdr, struct bnosample *smp) {
+   unsigned char buf[BNO_FRAME_MAX];
+   ssize_t len;
+
+   while((len = recv(fd, buf, sizeof(buf), 0)) < 0 && errno == EINTR);
+   if(len <= 0) return(-1);
+   if(bno_frame_decode(buf, len, hdr, smp) != 0) {
+      BNO_ERROR("Error: invalid frame from bno055d, %zd bytes.\n", len);
+      return(-1);
+   }
+   return(0);
+}
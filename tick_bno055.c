@@ -0,0 +1,67 @@
+/* ------------------------------------------------------------ *
+ * file:        tick_bno055.c                                   *
+ * purpose:     Drift-free periodic sampler. Deadlines are kept *
+ *              as absolute CLOCK_MONOTONIC times, start + n *  *
+ *              period, and slept to with clock_nanosleep() and *
+ *              TIMER_ABSTIME. The cost of the bus read and the *
+ *              output does not add up, a late sample skips the *
+ *              missed deadlines and counts them as overruns.   *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include "getbno055.h"
+
+static int64_t tick_ns(const struct timespec *ts) {
+   return (int64_t) ts->tv_sec * 1000000000LL + ts->tv_nsec;
+}
+
+/* ------------------------------------------------------------ *
+ * bno_tick_init() - start a sampler at rate hz, the first      *
+ * deadline is now. Returns -1 for a bad rate.                  *
+ * ------------------------------------------------------------ */
+int bno_tick_init(struct bnotick *tk, double hz) {
+   if(hz <= 0 || hz > BNO_TICK_MAX_HZ) {
+      BNO_ERROR("Error: invalid sample rate %.2f Hz, max %d Hz.\n", hz, BNO_TICK_MAX_HZ);
+      return(-1);
+   }
+   tk->period_ns = (int64_t)(1000000000.0 / hz + 0.5);
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   tk->next_ns  = tick_ns(&now);
+   tk->ticks    = 0;
+   tk->overruns = 0;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * bno_tick_wait() - sleep until the current deadline, then set *
+ * the next one a period later. A caller late by a full period  *
+ * or more skips the missed deadlines, the sample phase stays   *
+ * fixed. Returns the number of deadlines skipped this time     *
+ * (0 = on time), or -1 on error.                               *
+ * ------------------------------------------------------------ */
+int bno_tick_wait(struct bnotick *tk) {
+   struct timespec now;
+   int missed = 0;
+
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   int64_t late = tick_ns(&now) - tk->next_ns;
+   if(late >= tk->period_ns) {
+      missed = (int)(late / tk->period_ns);
+      tk->next_ns += (int64_t) missed * tk->period_ns;
+      tk->overruns += missed;
+   }
+
+   struct timespec until = { tk->next_ns / 1000000000LL, tk->next_ns % 1000000000LL };
+   int res;
+   while((res = clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL)) == EINTR);
+   if(res != 0) return(-1);
+
+   tk->next_ns += tk->period_ns;
+   tk->ticks++;
+   return(missed);
+}
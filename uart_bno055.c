@@ -0,0 +1,365 @@
+/* ------------------------------------------------------------ *
+ * file:        uart_bno055.c                                   *
+ * purpose:     BNO055 serial protocol bus transport, for the   *
+ *              sensor in UART mode (PS1 high). No clock        *
+ *              stretching, so no I2C controller stalls.        *
+ *              Selected with a tty bus name, e.g. /dev/ttyS0,  *
+ *              /dev/serial0 or uart:<any tty path>. In builds  *
+ *              with -DBNO_PTY_SIM (the tools, not the library) *
+ *              uart:sim talks to the pty stand-in of           *
+ *              pty_bno055.c.                                   *
+ *                                                              *
+ *              Frames (datasheet 4.7), 115200 8N1:             *
+ *              write: AA 00 <reg> <len> <data..> -> EE <status>*
+ *              read:  AA 01 <reg> <len> -> BB <len> <data..>   *
+ *                                      or EE <status>          *
+ *                                                              *
+ * author:      10/16/2026 agent                                *
+ * ------------------------------------------------------------ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "getbno055.h"
+
+#define UART_START          0xAA
+#define UART_READ_OK        0xBB
+#define UART_STATUS         0xEE
+#define UART_CMD_WRITE      0x00
+#define UART_CMD_READ       0x01
+#define UART_MAX_LEN        128  // length byte limit per frame
+#define UART_TIMEOUT_MS     100  // response timeout per frame
+#define UART_SILENCE_MS     15   // quiet line after an error, > 1 frame (11.3 ms)
+#define UART_RETRIES        8    // resends after bus over-run
+#define UART_PIPELINE_DEPTH 4    // read requests in flight
+
+/* ------------------------------------------------------------ *
+ * Status codes in the EE <status> response                     *
+ * ------------------------------------------------------------ */
+#define UART_WRITE_SUCCESS        0x01
+#define UART_READ_FAIL            0x02
+#define UART_WRITE_FAIL           0x03
+#define UART_REGMAP_INVALID_ADDR  0x04
+#define UART_REGMAP_WRITE_DISABLE 0x05
+#define UART_WRONG_START_BYTE     0x06
+#define UART_BUS_OVER_RUN_ERROR   0x07
+#define UART_MAX_LENGTH_ERROR     0x08
+#define UART_MIN_LENGTH_ERROR     0x09
+#define UART_RECEIVE_CHAR_TIMEOUT 0x0A
+
+struct uartdev{
+   int fd;                   // the tty
+   struct bnopty *pty;       // stand-in behind it, NULL = real port
+};
+
+/* ------------------------------------------------------------ *
+ * uart_retry_status() - the sensor asks for a resend if its    *
+ * receive buffer overflowed or a frame arrived incomplete.     *
+ * ------------------------------------------------------------ */
+static int uart_retry_status(int status) {
+   return status == UART_BUS_OVER_RUN_ERROR || status == UART_RECEIVE_CHAR_TIMEOUT;
+}
+
+/* ------------------------------------------------------------ *
+ * uart_recv() - read exactly len bytes, or fail on timeout     *
+ * ------------------------------------------------------------ */
+static int uart_recv(int fd, unsigned char *buf, int len) {
+   int got = 0;
+   while(got < len) {
+      struct pollfd pfd = { fd, POLLIN, 0 };
+      int res = poll(&pfd, 1, UART_TIMEOUT_MS);
+      if(res == 0) {
+         errno = ETIMEDOUT;
+         return(-1);
+      }
+      if(res < 0) {
+         if(errno == EINTR) continue;
+         return(-1);
+      }
+      ssize_t n = read(fd, buf + got, len - got);
+      if(n < 0 && errno == EINTR) continue;
+      if(n == 0) errno = EIO;          // hangup, errno not set
+      if(n <= 0) return(-1);
+      got += n;
+   }
+   return(0);
+}
+
+static int uart_send(int fd, const unsigned char *buf, int len) {
+   int sent = 0;
+   while(sent < len) {
+      ssize_t n = write(fd, buf + sent, len - sent);
+      if(n < 0 && errno == EINTR) continue;
+      if(n == 0) errno = EIO;
+      if(n <= 0) return(-1);
+      sent += n;
+   }
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * uart_drain() - after a failed window, up to three pipelined  *
+ * responses of ~11 ms each can still be on the wire. Discard   *
+ * input until the line was quiet for UART_SILENCE_MS, at most  *
+ * for 10 x UART_TIMEOUT_MS, then flush what the driver holds.  *
+ * Called on every failure after a request went out, so no late *
+ * response is taken as the reply to the next request. errno is *
+ * kept.                                                        *
+ * ------------------------------------------------------------ */
+static void uart_drain(int fd) {
+   unsigned char junk[256];
+   int err = errno;
+   int waited = 0;
+   while(waited < 10 * UART_TIMEOUT_MS) {
+      struct pollfd pfd = { fd, POLLIN, 0 };
+      int res = poll(&pfd, 1, UART_SILENCE_MS);
+      if(res < 0 && errno == EINTR) continue;
+      if(res <= 0) break;
+      if(read(fd, junk, sizeof(junk)) <= 0) break;
+      waited += UART_SILENCE_MS;
+   }
+   tcflush(fd, TCIFLUSH);
+   errno = err;
+}
+
+/* ------------------------------------------------------------ *
+ * uart_read_resp() - parse one read response into buf. Returns *
+ * 0 on success, the EE status code on a sensor error, or -1 if *
+ * the line timed out or delivered garbage, EE 00 included.     *
+ * ------------------------------------------------------------ */
+static int uart_read_resp(int fd, void *buf, int len) {
+   unsigned char hdr[2];
+   if(uart_recv(fd, hdr, 2) != 0) return(-1);
+
+   if(hdr[0] == UART_STATUS && hdr[1] != 0) return hdr[1];
+   if(hdr[0] != UART_READ_OK || hdr[1] != len) {
+      errno = EPROTO;
+      return(-1);
+   }
+   if(uart_recv(fd, buf, len) != 0) return(-1);
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * uart_free() - release the state, and the stand-in if any     *
+ * ------------------------------------------------------------ */
+static void uart_free(struct uartdev *dev) {
+#ifdef BNO_PTY_SIM
+   bno_pty_close(dev->pty);
+#endif
+   free(dev);
+}
+
+static int uart_open(struct bnotransport *t, const char *bus, int addr) {
+   if(strncmp(bus, "uart:", 5) == 0) bus += 5;
+
+   struct uartdev *dev = calloc(1, sizeof(struct uartdev));
+   if(dev == NULL) return(-1);
+#ifdef BNO_PTY_SIM
+   if(strncmp(bus, "sim", 3) == 0) {
+      if((dev->pty = bno_pty_open(bus, t->verbose)) == NULL) {
+         free(dev);
+         return(-1);
+      }
+      bus = bno_pty_name(dev->pty);
+   }
+#endif
+
+   int fd = open(bus, O_RDWR | O_NOCTTY);
+   if(fd < 0) {
+      BNO_ERROR("Error failed to open serial port [%s].\n", bus);
+      uart_free(dev);
+      return(-1);
+   }
+
+   struct termios tio;
+   if(tcgetattr(fd, &tio) != 0) {
+      BNO_ERROR("Error: [%s] is not a serial port.\n", bus);
+      close(fd);
+      uart_free(dev);
+      return(-1);
+   }
+   cfmakeraw(&tio);
+   cfsetispeed(&tio, B115200);
+   cfsetospeed(&tio, B115200);
+   tio.c_cflag |= CLOCAL | CREAD;
+   tio.c_cflag &= ~(CSTOPB | PARENB | CRTSCTS);
+   tio.c_cc[VMIN]  = 0;
+   tio.c_cc[VTIME] = 0;
+   if(tcsetattr(fd, TCSANOW, &tio) != 0) {
+      BNO_ERROR("Error: cannot set 115200 8N1 on [%s].\n", bus);
+      close(fd);
+      uart_free(dev);
+      return(-1);
+   }
+   tcflush(fd, TCIOFLUSH);
+
+   BNO_DEBUG(t->verbose, "Debug: UART device: [%s] 115200 8N1\n", bus);
+   dev->fd = fd;
+   t->priv = dev;
+   return(0);
+}
+
+/* ------------------------------------------------------------ *
+ * uart_read_multi() - read register blocks with pipelining: up *
+ * to UART_PIPELINE_DEPTH read frames go out in one write(),    *
+ * then the responses are collected in order. From the first    *
+ * bus over-run or garbled response on, the line is drained and *
+ * the rest is resent, for at most UART_RETRIES rounds.         *
+ * ------------------------------------------------------------ */
+static int uart_read_multi(struct bnotransport *t, struct bnoxfer *xfer, int count) {
+   int fd = ((struct uartdev *) t->priv)->fd;
+   int cur = 0;      // next block to request
+   int cur_off = 0;  // offset into that block
+   int retries = 0;
+
+   while(cur < count) {
+      /* ------------------------------------------------------ *
+       * Queue the next window of read requests, splitting any *
+       * block longer than the 128 byte frame limit            *
+       * ------------------------------------------------------ */
+      unsigned char req[UART_PIPELINE_DEPTH * 4];
+      int blk[UART_PIPELINE_DEPTH + 1];
+      int off[UART_PIPELINE_DEPTH + 1];
+      int len[UART_PIPELINE_DEPTH];
+      int n = 0;
+      int i = cur;
+      int o = cur_off;
+
+      while(i < count && n < UART_PIPELINE_DEPTH) {
+         int chunk = xfer[i].len - o;
+         if(chunk > UART_MAX_LEN) chunk = UART_MAX_LEN;
+         blk[n] = i;
+         off[n] = o;
+         len[n] = chunk;
+         req[4*n]   = UART_START;
+         req[4*n+1] = UART_CMD_READ;
+         req[4*n+2] = xfer[i].reg + o;
+         req[4*n+3] = chunk;
+         n++;
+         o += chunk;
+         if(o >= xfer[i].len) { i++; o = 0; }
+      }
+      blk[n] = i;   // position after the window
+      off[n] = o;
+
+      if(uart_send(fd, req, 4 * n) != 0) return(-1);
+
+      /* ------------------------------------------------------ *
+       * Collect the responses in order, stop at the first one *
+       * that failed and resume from there on the next round.  *
+       * ------------------------------------------------------ */
+      int ok = 0;
+      int status = 0;
+      while(ok < n) {
+         unsigned char *dst = (unsigned char *) xfer[blk[ok]].buf + off[ok];
+         status = uart_read_resp(fd, dst, len[ok]);
+         if(status != 0) break;
+         ok++;
+      }
+      cur = blk[ok];
+      cur_off = off[ok];
+      if(ok == n) {
+         retries = 0;
+         continue;
+      }
+
+      if(status > 0 && !uart_retry_status(status)) {
+         BNO_ERROR("Error: UART read failure for register data 0x%02X, status 0x%02X\n", req[4*ok+2], status);
+         errno = EINVAL;
+         uart_drain(fd);
+         return(-1);
+      }
+      if(++retries > UART_RETRIES) {
+         if(status > 0) errno = EIO;
+         uart_drain(fd);
+         return(-1);
+      }
+      if(status > 0) BNO_DEBUG(t->verbose, "Debug: UART resend from register 0x%02X, status 0x%02X\n", req[4*ok+2], status);
+      else BNO_DEBUG(t->verbose, "Debug: UART resend from register 0x%02X, %s\n", req[4*ok+2], strerror(errno));
+
+      /* ------------------------------------------------------ *
+       * Drop the rest of the window, late responses included  *
+       * ------------------------------------------------------ */
+      uart_drain(fd);
+   }
+   return(0);
+}
+
+static int uart_read_regs(struct bnotransport *t, unsigned char reg, void *buf, int len) {
+   struct bnoxfer xfer = { reg, len, buf };
+   return uart_read_multi(t, &xfer, 1);
+}
+
+/* ------------------------------------------------------------ *
+ * uart_write_regs() - write frames of up to 128 data bytes,    *
+ * resending a frame after a bus over-run status response.      *
+ * ------------------------------------------------------------ */
+static int uart_write_regs(struct bnotransport *t, unsigned char reg, const void *buf, int len) {
+   int fd = ((struct uartdev *) t->priv)->fd;
+   const unsigned char *data = buf;
+   int off = 0;
+   int retries = 0;
+
+   while(off < len) {
+      int chunk = len - off;
+      if(chunk > UART_MAX_LEN) chunk = UART_MAX_LEN;
+
+      unsigned char req[4 + UART_MAX_LEN];
+      req[0] = UART_START;
+      req[1] = UART_CMD_WRITE;
+      req[2] = reg + off;
+      req[3] = chunk;
+      memcpy(&req[4], data + off, chunk);
+      if(uart_send(fd, req, 4 + chunk) != 0) return(-1);
+
+      unsigned char resp[2];
+      int status = -1;
+      if(uart_recv(fd, resp, 2) == 0) {
+         if(resp[0] == UART_STATUS && resp[1] != 0) status = resp[1];
+         else errno = EPROTO;
+      }
+
+      if(status == UART_WRITE_SUCCESS) {
+         off += chunk;
+         retries = 0;
+         continue;
+      }
+      if(status > 0 && !uart_retry_status(status)) {
+         BNO_ERROR("Error: UART write failure for register 0x%02X, status 0x%02X\n", req[2], status);
+         errno = EINVAL;
+         uart_drain(fd);
+         return(-1);
+      }
+      if(++retries > UART_RETRIES) {
+         if(status > 0) errno = EIO;
+         uart_drain(fd);
+         return(-1);
+      }
+      uart_drain(fd);
+   }
+   return(0);
+}
+
+static void uart_close(struct bnotransport *t) {
+   struct uartdev *dev = t->priv;
+   close(dev->fd);
+   uart_free(dev);
+   t->priv = NULL;
+}
+
+const struct bnotransport bno_uart_transport = {
+   "uart",
+   uart_open,
+   uart_read_regs,
+   uart_read_multi,
+   uart_write_regs,
+   uart_close,
+   NULL,
+   NULL,
+   NULL
+};